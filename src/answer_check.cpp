@@ -0,0 +1,293 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <answer_check.h>
+#include <rational.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <vector>
+
+namespace
+{
+    static constexpr std::size_t MAXIMUM_DEPTH = 256; //!< parentheses open at once. Deeper answers are rejected rather than exhausting the stack
+
+    /// \brief thrown to unwind the parser with a verdict
+    struct rejection
+    {
+        answer_verdict verdict;
+
+        std::size_t position;
+    };
+
+    class evaluator final
+    {
+        const std::string &m_Text;
+
+        std::size_t m_Position = 0;
+
+        std::size_t m_Depth = 0; //!< parentheses open
+
+        std::size_t m_SignAllowed = 0; //!< where a negative number may start: the beginning of the answer or of a parenthesized expression
+
+        std::vector<input_type> m_Numbers; //!< values of the numbers read, as the hand's numbers would parse
+
+        [[noreturn]] void reject(const answer_verdict verdict) const
+        {
+            throw rejection{verdict, m_Position};
+        }
+
+        std::int64_t multiply(const std::int64_t a, const std::int64_t b) const
+        {
+            std::int64_t output;
+
+            if (!checkedMultiply(a, b, output)) reject(answer_verdict::overflow);
+
+            return output;
+        }
+
+        std::int64_t add(const std::int64_t a, const std::int64_t b) const
+        {
+            std::int64_t output;
+
+            if (!checkedAdd(a, b, output)) reject(answer_verdict::overflow);
+
+            return output;
+        }
+
+        rational apply(const rational &l, const rational &r, const Operation operation) const
+        {
+            if (operation == Operation::Division && !r.numerator) reject(answer_verdict::division_by_zero);
+
+            rational output;
+
+            if (!applyOperation(l, r, operation, output)) reject(answer_verdict::overflow);
+
+            return output;
+        }
+
+        void skipSpaces()
+        {
+            while (m_Position < m_Text.size() && std::isspace(static_cast<unsigned char>(m_Text[m_Position]))) ++m_Position;
+        }
+
+        /// \brief true if the next character is c, consuming it
+        bool accept(const char c)
+        {
+            skipSpaces();
+
+            if (m_Position >= m_Text.size() || m_Text[m_Position] != c) return false;
+
+            ++m_Position;
+
+            return true;
+        }
+
+        /// \brief a decimal number, optionally negative, with an optional fraction and exponent
+        rational number()
+        {
+            const auto begin = m_Position;
+
+            const bool negative = m_Text[m_Position] == '-';
+
+            if (negative) ++m_Position;
+
+            std::int64_t digits(0), scale(1);
+
+            const auto readDigits = [&](const bool fractional)
+            {
+                const auto first = m_Position;
+
+                for (; m_Position < m_Text.size() && std::isdigit(static_cast<unsigned char>(m_Text[m_Position])); ++m_Position)
+                {
+                    digits = add(multiply(digits, 10), m_Text[m_Position] - '0');
+
+                    if (fractional) scale = multiply(scale, 10);
+                }
+
+                return m_Position > first;
+            };
+
+            bool any = readDigits(false);
+
+            if (m_Position < m_Text.size() && m_Text[m_Position] == '.')
+            {
+                ++m_Position;
+
+                any = readDigits(true) || any;
+            }
+
+            if (!any) reject(answer_verdict::malformed);
+
+            if (m_Position < m_Text.size() && (m_Text[m_Position] == 'e' || m_Text[m_Position] == 'E'))
+            {
+                ++m_Position;
+
+                const bool negativeExponent = m_Position < m_Text.size() && m_Text[m_Position] == '-';
+
+                if (m_Position < m_Text.size() && (m_Text[m_Position] == '-' || m_Text[m_Position] == '+')) ++m_Position;
+
+                int exponent(0);
+
+                const auto result = std::from_chars(m_Text.data() + m_Position, m_Text.data() + m_Text.size(), exponent);
+
+                if (result.ec != std::errc()) reject(result.ec == std::errc::result_out_of_range ? answer_verdict::overflow : answer_verdict::malformed);
+
+                m_Position = result.ptr - m_Text.data();
+
+                if (digits) for (int i(0); i < exponent; ++i)
+                {
+                    if (negativeExponent) scale = multiply(scale, 10);
+                    else digits = multiply(digits, 10);
+                }
+            }
+
+            input_type value;
+
+            const auto result = std::from_chars(m_Text.data() + begin, m_Text.data() + m_Position, value);
+
+            if (result.ec != std::errc()) reject(answer_verdict::malformed);
+
+            m_Numbers.push_back(value);
+
+            rational output;
+
+            if (!makeRational(negative ? -digits : digits, scale, output)) reject(answer_verdict::overflow);
+
+            return output;
+        }
+
+        rational primary()
+        {
+            skipSpaces();
+
+            if (m_Position >= m_Text.size()) reject(answer_verdict::malformed);
+
+            if (accept('('))
+            {
+                if (++m_Depth > MAXIMUM_DEPTH) reject(answer_verdict::malformed);
+
+                skipSpaces();
+
+                m_SignAllowed = m_Position;
+
+                const auto value = expression(0);
+
+                if (!accept(')')) reject(answer_verdict::malformed);
+
+                --m_Depth;
+
+                return value;
+            }
+
+            if (m_Text[m_Position] == '-' && m_Position != m_SignAllowed) reject(answer_verdict::malformed); // there is no unary minus
+
+            return number();
+        }
+
+        /// \brief an expression whose operators all bind at least as tightly as minimumPrecedence, left associative
+        rational expression(const int minimumPrecedence)
+        {
+            auto value = primary();
+
+            for (;;)
+            {
+                skipSpaces();
+
+                if (m_Position >= m_Text.size()) return value;
+
+                Operation operation;
+
+                switch (m_Text[m_Position])
+                {
+                    case '+': operation = Operation::Addition; break;
+                    case '-': operation = Operation::Subtraction; break;
+                    case '*': operation = Operation::Multiplication; break;
+                    case '/': operation = Operation::Division; break;
+
+                    default: return value;
+                }
+
+                const int precedence = operation == Operation::Addition || operation == Operation::Subtraction ? 1 : 2;
+
+                if (precedence < minimumPrecedence) return value;
+
+                ++m_Position;
+
+                value = apply(value, expression(precedence + 1), operation);
+            }
+        }
+
+    public:
+        explicit evaluator(const std::string &text)
+        : m_Text(text)
+        {}
+
+        /// \brief the value of the whole text
+        rational evaluate()
+        {
+            skipSpaces();
+
+            m_SignAllowed = m_Position;
+
+            const auto value = expression(0);
+
+            skipSpaces();
+
+            if (m_Position != m_Text.size()) reject(answer_verdict::malformed);
+
+            return value;
+        }
+
+        std::vector<input_type> &numbers()
+        {
+            return m_Numbers;
+        }
+    };
+}
+
+std::string answer_check::message() const
+{
+    switch (verdict)
+    {
+        case answer_verdict::correct: return "correct";
+        case answer_verdict::malformed: return "not a valid expression, at character " + std::to_string(position + 1);
+        case answer_verdict::wrong_numbers: return "does not use each number of the hand exactly once";
+        case answer_verdict::division_by_zero: return "divides by zero";
+        case answer_verdict::overflow: return "too large to evaluate exactly, at character " + std::to_string(position + 1);
+        case answer_verdict::wrong_value: return "does not equal the target";
+
+        default: return "unknown verdict";
+    }
+}
+
+answer_check checkAnswer(const input_type targetNumber, input_collection_type input, const std::string &answer)
+{
+    try
+    {
+        evaluator e(answer);
+
+        const auto value = e.evaluate();
+
+        auto &numbers = e.numbers();
+
+        std::sort(numbers.begin(), numbers.end());
+
+        std::sort(input.begin(), input.end());
+
+        if (numbers != input) return {answer_verdict::wrong_numbers};
+
+        // the target is the decimal number it is written as: 0.1 is 1/10
+        rational target;
+
+        if (!decimalRational(targetNumber, target)) return {answer_verdict::wrong_value}; // not finite, equal to no answer
+
+        // both are in lowest terms
+        if (value != target) return {answer_verdict::wrong_value};
+
+        return {answer_verdict::correct};
+    }
+    catch (const rejection &r)
+    {
+        return {r.verdict, r.position};
+    }
+}
@@ -0,0 +1,218 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <backward_search.h>
+#include <expression_tables.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+namespace
+{
+    static constexpr std::size_t MAXIMUM_AUTOMATIC_TABLE_LIMIT = 6; //!< tables of 7 operands hold over a million values each
+
+    /// \brief the values at which the operations stop being monotonic, tried one at a time
+    static constexpr input_type SPECIAL_VALUES[] = {-std::numeric_limits<input_type>::infinity(), -0.0, 0.0, std::numeric_limits<input_type>::infinity()};
+
+    /// \brief keys of the finite non-zero values of each sign, inclusive
+    const std::uint64_t SEGMENTS[][2] = {
+        {valueKey(-std::numeric_limits<input_type>::max()), valueKey(-std::numeric_limits<input_type>::denorm_min())},
+        {valueKey(std::numeric_limits<input_type>::denorm_min()), valueKey(std::numeric_limits<input_type>::max())}};
+
+    /// \brief an operation with one operand fixed to a, as a function of the other operand
+    struct partial_operation
+    {
+        input_type a;
+
+        Operation operation;
+
+        bool aIsLeft;
+
+        input_type operator()(const input_type b) const
+        {
+            return aIsLeft ? Operation_PerformOperation(a, b, operation) : Operation_PerformOperation(b, a, operation);
+        }
+    };
+
+    /// \brief first key in [begin, end) for which predicate holds, or end. predicate must be false then true over the range
+    template<class Predicate>
+    std::uint64_t firstKey(std::uint64_t begin, std::uint64_t end, Predicate &&predicate)
+    {
+        while (begin < end)
+        {
+            const auto middle = begin + (end - begin) / 2;
+
+            if (predicate(middle)) end = middle;
+            else begin = middle + 1;
+        }
+
+        return begin;
+    }
+
+    class backward_search final
+    {
+        const expression_tables &m_Tables;
+
+        const std::size_t m_TableLimit;
+
+        backward_stats &m_Stats;
+
+        std::vector<std::vector<std::size_t>> m_Splits; //!< per sub-multiset, its non-empty parts no larger than the rest. Filled on first use
+
+        const std::vector<std::size_t> &splits(const std::size_t subset)
+        {
+            auto &output = m_Splits[subset];
+
+            if (output.empty()) for (std::size_t part(1); part < subset; ++part)
+            {
+                if (m_Tables.includes(subset, part) && m_Tables.operandCount(part) * 2 <= m_Tables.operandCount(subset)) output.push_back(part);
+            }
+
+            return output;
+        }
+
+        /// \brief true if the table of subset holds a value with a key in [low, high]
+        bool lookup(const std::size_t subset, const std::uint64_t low, const std::uint64_t high)
+        {
+            ++m_Stats.lookups;
+
+            const auto &values = m_Tables.table(subset).values;
+
+            const auto it = std::lower_bound(values.begin(), values.end(), low, [](const input_type v, const std::uint64_t k) { return valueKey(v) < k; });
+
+            return it != values.end() && valueKey(*it) <= high;
+        }
+
+        /// \brief true if rest can produce a b with f(b) in [low, high]
+        bool reachesThrough(const std::size_t rest, const partial_operation &f, const std::uint64_t low, const std::uint64_t high)
+        {
+            const auto keyOf = [&f](const input_type b)
+            {
+                const auto value = f(b);
+
+                return std::isnan(value) ? std::optional<std::uint64_t>() : valueKey(value);
+            };
+
+            const auto inRange = [&](const input_type b)
+            {
+                const auto key = keyOf(b);
+
+                return key && low <= *key && *key <= high;
+            };
+
+            if (m_Tables.operandCount(rest) <= m_TableLimit)
+            {
+                // the values of the table are searched directly rather than the values of a segment
+                ++m_Stats.lookups;
+
+                const auto &values = m_Tables.table(rest).values;
+
+                for (const auto special : SPECIAL_VALUES)
+                {
+                    if (inRange(special) && m_Tables.table(rest).find(valueKey(special)) < values.size()) return true;
+                }
+
+                for (const auto &segment : SEGMENTS)
+                {
+                    const auto begin = std::lower_bound(values.begin(), values.end(), segment[0], [](const input_type v, const std::uint64_t k) { return valueKey(v) < k; });
+
+                    const auto end = std::upper_bound(begin, values.end(), segment[1], [](const std::uint64_t k, const input_type v) { return k < valueKey(v); });
+
+                    if (begin == end) continue;
+
+                    const bool increasing = *keyOf(*begin) <= *keyOf(*(end - 1));
+
+                    const auto first = std::partition_point(begin, end, [&](const input_type b) { return increasing ? *keyOf(b) < low : *keyOf(b) > high; });
+
+                    if (first != end && inRange(*first)) return true;
+                }
+
+                return false;
+            }
+
+            for (const auto special : SPECIAL_VALUES)
+            {
+                if (inRange(special) && reaches(rest, valueKey(special), valueKey(special))) return true;
+            }
+
+            for (const auto &segment : SEGMENTS)
+            {
+                const auto keyOfKey = [&keyOf](const std::uint64_t k) { return *keyOf(valueFromKey(k)); };
+
+                const bool increasing = keyOfKey(segment[0]) <= keyOfKey(segment[1]);
+
+                // the b in the segment with f(b) in range: [first, last)
+                const auto first = firstKey(segment[0], segment[1] + 1, [&](const std::uint64_t k) { return increasing ? keyOfKey(k) >= low : keyOfKey(k) <= high; });
+
+                const auto last = firstKey(first, segment[1] + 1, [&](const std::uint64_t k) { return increasing ? keyOfKey(k) > high : keyOfKey(k) < low; });
+
+                if (first < last && reaches(rest, first, last - 1)) return true;
+            }
+
+            return false;
+        }
+
+    public:
+        backward_search(const expression_tables &tables, const std::size_t tableLimit, backward_stats &stats)
+        : m_Tables(tables)
+        , m_TableLimit(tableLimit)
+        , m_Stats(stats)
+        , m_Splits(tables.size())
+        {}
+
+        /// \brief true if some expression over subset has a value with a key in [low, high]
+        bool reaches(const std::size_t subset, const std::uint64_t low, const std::uint64_t high)
+        {
+            if (m_Tables.operandCount(subset) <= m_TableLimit) return lookup(subset, low, high);
+
+            ++m_Stats.queries;
+
+            for (const auto part : splits(subset))
+            {
+                const auto rest = subset - part;
+
+                for (const auto a : m_Tables.table(part).values)
+                {
+                    for (std::size_t o(0); o < Operation_Count; ++o)
+                    {
+                        const auto operation = static_cast<Operation>(o);
+
+                        if (reachesThrough(rest, {a, operation, true}, low, high)) return true;
+
+                        // addition and multiplication commute, the rest on the left adds nothing
+                        if ((operation == Operation::Subtraction || operation == Operation::Division) && reachesThrough(rest, {a, operation, false}, low, high)) return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+    };
+}
+
+bool isSolvable(const input_type targetNumber, input_collection_type input, backward_stats *stats, std::size_t tableLimit)
+{
+    if (input.empty() || std::isnan(targetNumber)) return false;
+
+    // the smaller part of every split must have a table
+    const auto smallestLimit = (input.size() + 1) / 2;
+
+    if (!tableLimit) tableLimit = std::min(input.size() > 2 ? input.size() - 2 : 1, MAXIMUM_AUTOMATIC_TABLE_LIMIT);
+
+    tableLimit = std::max(tableLimit, smallestLimit);
+
+    backward_stats localStats;
+
+    auto &searchStats = stats ? *stats : localStats;
+
+    searchStats.tableLimit = tableLimit;
+
+    const expression_tables tables(std::move(input), true, tableLimit);
+
+    backward_search search(tables, tableLimit, searchStats);
+
+    // both zeros compare equal to a zero target
+    if (targetNumber == 0) return search.reaches(tables.full(), valueKey(-0.0), valueKey(0.0));
+
+    return search.reaches(tables.full(), valueKey(targetNumber), valueKey(targetNumber));
+}
@@ -0,0 +1,733 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <batch.h>
+#include <binary_results.h>
+#include <bounded_queue.h>
+#include <expression.h>
+#include <expression_tables.h>
+#include <mapped_file.h>
+#include <ndjson.h>
+#include <table_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct batch_hand
+    {
+        std::size_t sequence;
+
+        input_collection_type input;
+    };
+
+    struct batch_result
+    {
+        std::size_t sequence;
+
+        input_collection_type input; //!< as given, for display
+
+        solution_set result; //!< when counting, holds the first solution only
+
+        expression_count count = 0; //!< number of solutions
+
+        std::string error;
+    };
+
+    /// \brief one row of the binary columnar output
+    struct batch_record
+    {
+        std::uint64_t id;
+
+        double target;
+
+        std::uint64_t count;
+
+        std::uint64_t solution;
+    };
+
+    struct batch_chunk
+    {
+        std::size_t sequence;
+
+        std::string text; //!< batch_format::text
+
+        batch_record record; //!< batch_format::binary
+    };
+
+    static constexpr std::size_t QUEUE_CAPACITY = 1024;
+
+    static constexpr std::size_t REORDER_WINDOW = 1 << 14; //!< maximum number of hands in flight between the parser and the writer
+
+    static constexpr std::size_t MAPPED_CHUNK_SIZE = 1 << 15; //!< bytes of mapped input claimed by a parser at a time
+
+    bool isBlank(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    /// \brief parses the whitespace separated numbers in [begin, end). Returns false if the line contains no hand
+    bool parseHand(const char *begin, const char *end, const std::size_t lineNumber, input_collection_type &input)
+    {
+        input.clear();
+
+        for (const char *it = begin;;)
+        {
+            while (it != end && isBlank(*it)) ++it;
+
+            if (it == end) break;
+
+            const char *tokenEnd = it;
+
+            while (tokenEnd != end && !isBlank(*tokenEnd)) ++tokenEnd;
+
+            input_type value;
+
+            const auto result = std::from_chars(it + (*it == '+'), tokenEnd, value);
+
+            if (result.ec != std::errc() || result.ptr != tokenEnd)
+            {
+                std::cerr << "line " << lineNumber << ": input contains invalid parameter: \"" << std::string(it, tokenEnd)
+                    << "\". All inputs must be integer or floating point numbers" << std::endl;
+
+                input.clear();
+
+                return true;
+            }
+
+            input.push_back(value);
+
+            it = tokenEnd;
+        }
+
+        return !input.empty();
+    }
+
+    bool isBlankLine(const char *begin, const char *end)
+    {
+        return std::all_of(begin, end, isBlank);
+    }
+
+    /// \brief a line aligned range of mapped input
+    struct mapped_chunk
+    {
+        const char *begin;
+        const char *end;
+
+        std::size_t firstLine; //!< 1 based line number of begin
+        std::size_t firstSequence; //!< sequence number of the first hand in the range
+    };
+
+    /// \brief splits the mapped file into ranges that end on line boundaries, counting lines and hands so that each range can be parsed independently
+    std::vector<mapped_chunk> splitMappedInput(const char *begin, const char *end)
+    {
+        std::vector<mapped_chunk> chunks;
+
+        std::size_t line(1), sequence(0);
+
+        for (const char *it = begin; it != end;)
+        {
+            mapped_chunk chunk{it, nullptr, line, sequence};
+
+            const char *limit = static_cast<std::size_t>(end - it) > MAPPED_CHUNK_SIZE ? it + MAPPED_CHUNK_SIZE : end;
+
+            while (it != end && (it < limit || it == chunk.begin))
+            {
+                const auto *newline = static_cast<const char *>(std::memchr(it, '\n', end - it));
+
+                const char *lineEnd = newline ? newline : end;
+
+                if (!isBlankLine(it, lineEnd)) ++sequence;
+
+                ++line;
+
+                it = newline ? newline + 1 : end;
+            }
+
+            chunk.end = it;
+
+            chunks.push_back(chunk);
+        }
+
+        return chunks;
+    }
+
+    /// \brief text and infix formats: each solution unless only counting, followed by a summary line
+    void formatResult(std::string &buffer, const batch_result &r, const batch_format format, const bool countOnly)
+    {
+        std::stringstream ss;
+
+        if (!r.error.empty()) ss << "error: " << r.error << "\n";
+
+        if (countOnly) {}
+        else if (format == batch_format::infix)
+        {
+            const infix_renderer renderer(r.result.input);
+
+            std::string line;
+
+            for (const auto &s : r.result.solutions)
+            {
+                line.clear();
+
+                renderer.write(line, s);
+
+                ss << line << "\n";
+            }
+        }
+        else for (const auto &s : r.result.solutions)
+        {
+            formatSolutionTrace(ss, r.result.input, s);
+
+            ss << "==========\n";
+        }
+
+        ss << "{";
+
+        for (decltype(r.input.size()) i = 0, s = r.input.size(); i < s; ++i)
+        {
+            ss << r.input[i];
+
+            if (i != s - 1) ss << ", ";
+        }
+
+        const auto size = r.count;
+
+        ss << "}: ";
+
+        if (!size) ss << "No solution\n";
+        else ss << size << " solution" << (size > 1 ? "s" : "") << "\n";
+
+        buffer = ss.str();
+    }
+
+    batch_record makeRecord(const batch_result &r, const multiset_index *hands)
+    {
+        const auto &solutions = r.result.solutions;
+
+        return
+        {
+            hands && r.error.empty() ? hands->rank(r.result.input) : r.sequence, // a census fails no hand, and ranks hands in census order
+
+            r.result.target,
+            r.count,
+            solutions.empty() ? no_solution_code : encodeSolution(r.result.input, solutions.front())
+        };
+    }
+
+    /// \brief accumulates records into column blocks and writes each block once it is full
+    class binary_results_writer final
+    {
+        static constexpr std::uint32_t BLOCK_RECORDS = 4096;
+
+        std::FILE *const m_Output;
+
+        std::vector<std::uint64_t> m_Ids, m_Counts, m_Solutions;
+
+        std::vector<double> m_Targets;
+
+        std::uint64_t m_RecordCount = 0;
+
+        long m_HeaderPosition;
+
+        void writeBlock()
+        {
+            const auto size = m_Ids.size();
+
+            m_Ids.resize(BLOCK_RECORDS, binary_results_padding_id);
+            m_Targets.resize(BLOCK_RECORDS, 0);
+            m_Counts.resize(BLOCK_RECORDS, 0);
+            m_Solutions.resize(BLOCK_RECORDS, no_solution_code);
+
+            std::fwrite(m_Ids.data(), sizeof(std::uint64_t), BLOCK_RECORDS, m_Output);
+            std::fwrite(m_Targets.data(), sizeof(double), BLOCK_RECORDS, m_Output);
+            std::fwrite(m_Counts.data(), sizeof(std::uint64_t), BLOCK_RECORDS, m_Output);
+            std::fwrite(m_Solutions.data(), sizeof(std::uint64_t), BLOCK_RECORDS, m_Output);
+
+            m_RecordCount += size;
+
+            m_Ids.clear();
+            m_Targets.clear();
+            m_Counts.clear();
+            m_Solutions.clear();
+        }
+
+        const multiset_index *const m_Hands;
+
+        binary_results_header header(const std::uint64_t recordCount) const
+        {
+            binary_results_header output{};
+
+            std::copy(std::begin(binary_results_magic), std::end(binary_results_magic), output.magic);
+
+            output.version = binary_results_version;
+            output.block_records = BLOCK_RECORDS;
+            output.flags = 0;
+            output.record_count = recordCount;
+
+            if (m_Hands)
+            {
+                output.flags = binary_results_id_is_rank | static_cast<std::uint32_t>(m_Hands->size()) << binary_results_rank_size_shift;
+                output.rank_low = m_Hands->low();
+                output.rank_high = m_Hands->high();
+            }
+
+            return output;
+        }
+
+    public:
+        binary_results_writer(std::FILE *output, const multiset_index *hands)
+        : m_Output(output)
+        , m_HeaderPosition(std::ftell(output))
+        , m_Hands(hands)
+        {
+            m_Ids.reserve(BLOCK_RECORDS);
+            m_Targets.reserve(BLOCK_RECORDS);
+            m_Counts.reserve(BLOCK_RECORDS);
+            m_Solutions.reserve(BLOCK_RECORDS);
+
+            const auto h = header(binary_results_unknown_count);
+
+            std::fwrite(&h, sizeof(h), 1, m_Output);
+        }
+
+        void append(const batch_record &r)
+        {
+            m_Ids.push_back(r.id);
+            m_Targets.push_back(r.target);
+            m_Counts.push_back(r.count);
+            m_Solutions.push_back(r.solution);
+
+            if (m_Ids.size() == BLOCK_RECORDS) writeBlock();
+        }
+
+        /// \brief writes the last, padded block and records the final count in the header if the output can be rewound
+        void finish()
+        {
+            if (!m_Ids.empty()) writeBlock();
+
+            if (m_HeaderPosition < 0 || std::fseek(m_Output, m_HeaderPosition, SEEK_SET)) return;
+
+            const auto h = header(m_RecordCount);
+
+            std::fwrite(&h, sizeof(h), 1, m_Output);
+
+            std::fseek(m_Output, 0, SEEK_END);
+        }
+    };
+
+    /// \brief the result of one hand, without its sequence number and input
+    batch_result solveHand(const input_collection_type &input, const batch_options &options, table_cache &cache)
+    {
+        batch_result r;
+
+        try
+        {
+            if (options.countOnly)
+            {
+                const expression_tables tables(input, false, solution::max_operands, &cache);
+
+                r.result = {options.target, tables.input(), {}};
+
+                r.count = tables.count(options.target);
+
+                if (r.count) r.result.solutions.push_back(tables.unrank(options.target, 0));
+            }
+            else
+            {
+                r.result = findSolutions(options.target, input);
+
+                r.count = r.result.solutions.size();
+            }
+        }
+        catch (const std::exception &e)
+        {
+            r.error = e.what();
+        }
+
+        return r;
+    }
+
+    /// \brief runs the pipeline. produce(parserIndex, emit) is run on parserCount threads and calls emit(sequence, input) for each hand.
+    /// Sequence numbers must be dense and start at 0; each parser must emit its hands in increasing sequence order.
+    /// solve(hand) returns the result of a hand
+    template<class Produce, class Solve>
+    void runPipeline(std::FILE *output, const batch_options &options, const unsigned parserCount, Produce &&produce, Solve &&solve)
+    {
+        const unsigned solverCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        const unsigned formatterCount = std::max(1u, solverCount / 4);
+
+        bounded_queue<batch_hand> hands(QUEUE_CAPACITY);
+
+        bounded_queue<batch_result> results(QUEUE_CAPACITY);
+
+        bounded_queue<batch_chunk> chunks(QUEUE_CAPACITY);
+
+        std::atomic<std::size_t> written{0};
+
+        //
+        // 1. parse
+        //
+        const auto emit = [&hands, &written](const std::size_t sequence, input_collection_type &input)
+        {
+            for (unsigned attempt(0); sequence >= written.load(std::memory_order_acquire) + REORDER_WINDOW; ++attempt)
+            {
+                if (attempt > 64) std::this_thread::yield();
+            }
+
+            hands.push(batch_hand{sequence, std::move(input)});
+        };
+
+        std::atomic<unsigned> parsersRemaining{parserCount};
+
+        std::vector<std::thread> parsers;
+
+        for (unsigned i(0); i < parserCount; ++i) parsers.emplace_back([&, i]()
+        {
+            produce(i, emit);
+
+            if (parsersRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) hands.close();
+        });
+
+        //
+        // 2. solve
+        //
+        std::atomic<unsigned> solversRemaining{solverCount};
+
+        std::vector<std::thread> solvers;
+
+        for (unsigned i(0); i < solverCount; ++i) solvers.emplace_back([&]()
+        {
+            batch_hand hand;
+
+            while (hands.pop(hand))
+            {
+                auto r = solve(hand);
+
+                r.sequence = hand.sequence;
+
+                r.input = std::move(hand.input);
+
+                results.push(std::move(r));
+            }
+
+            if (solversRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) results.close();
+        });
+
+        //
+        // 3. format
+        //
+        std::atomic<unsigned> formattersRemaining{formatterCount};
+
+        std::vector<std::thread> formatters;
+
+        for (unsigned i(0); i < formatterCount; ++i) formatters.emplace_back([&]()
+        {
+            batch_result r;
+
+            std::string buffer; // reused by the JSON encoder for every hand
+
+            while (results.pop(r))
+            {
+                batch_chunk chunk;
+
+                chunk.sequence = r.sequence;
+
+                switch (options.format)
+                {
+                    case batch_format::binary: chunk.record = makeRecord(r, options.hands); break;
+
+                    case batch_format::ndjson:
+                    {
+                        buffer.clear();
+
+                        if (options.countOnly) writeNdjsonCount(buffer, r.input, options.target, r.count, r.error);
+                        else writeNdjsonResult(buffer, r.input, r.result, r.error);
+
+                        chunk.text.assign(buffer);
+                    } break;
+
+                    default: formatResult(chunk.text, r, options.format, options.countOnly);
+                }
+
+                chunks.push(std::move(chunk));
+            }
+
+            if (formattersRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) chunks.close();
+        });
+
+        //
+        // 4. write, in input order
+        //
+        std::vector<std::string> pending(REORDER_WINDOW);
+
+        std::vector<bool> present(REORDER_WINDOW, false);
+
+        std::size_t next(0);
+
+        batch_chunk chunk;
+
+        std::unique_ptr<binary_results_writer> binary;
+
+        if (options.format == batch_format::binary) binary = std::make_unique<binary_results_writer>(output, options.hands);
+
+        std::vector<batch_record> pendingRecords(binary ? REORDER_WINDOW : 0);
+
+        while (chunks.pop(chunk))
+        {
+            const auto slot = chunk.sequence % REORDER_WINDOW;
+
+            if (binary) pendingRecords[slot] = chunk.record;
+            else pending[slot] = std::move(chunk.text);
+
+            present[slot] = true;
+
+            for (auto s = next % REORDER_WINDOW; present[s]; s = next % REORDER_WINDOW)
+            {
+                if (binary) binary->append(pendingRecords[s]);
+                else std::fwrite(pending[s].data(), 1, pending[s].size(), output);
+
+                pending[s].clear();
+                present[s] = false;
+
+                written.store(++next, std::memory_order_release);
+            }
+        }
+
+        for (auto &t : parsers) t.join();
+
+        for (auto &t : solvers) t.join();
+
+        for (auto &t : formatters) t.join();
+
+        if (binary) binary->finish();
+
+        std::fflush(output);
+    }
+
+    /// \brief solves each distinct hand once, in sorted order, then runs the pipeline over the hands in input order with the results fanned back out.
+    /// Every hand is held in memory
+    template<class Produce>
+    void runDeduplicated(std::FILE *output, const batch_options &options, const unsigned parserCount, Produce &&produce)
+    {
+        const unsigned solverCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        //
+        // 1. collect every hand
+        //
+        std::vector<input_collection_type> hands;
+
+        std::mutex handsMutex;
+
+        {
+            const auto emit = [&hands, &handsMutex](const std::size_t sequence, input_collection_type &input)
+            {
+                std::lock_guard<std::mutex> lock(handsMutex);
+
+                if (sequence >= hands.size()) hands.resize(sequence + 1);
+
+                hands[sequence] = std::move(input);
+            };
+
+            std::vector<std::thread> parsers;
+
+            for (unsigned i(0); i < parserCount; ++i) parsers.emplace_back([&, i]() { produce(i, emit); });
+
+            for (auto &t : parsers) t.join();
+        }
+
+        //
+        // 2. canonicalise: the hand as a sorted multiset, ordered so that hands sharing small values are solved together
+        //
+        std::vector<input_collection_type> canonical(hands.size());
+
+        for (decltype(hands.size()) i(0); i < hands.size(); ++i)
+        {
+            canonical[i] = hands[i];
+
+            std::sort(canonical[i].begin(), canonical[i].end());
+        }
+
+        std::vector<std::size_t> order(hands.size());
+
+        for (decltype(order.size()) i(0); i < order.size(); ++i) order[i] = i;
+
+        std::stable_sort(order.begin(), order.end(), [&canonical](const std::size_t a, const std::size_t b) { return canonical[a] < canonical[b]; });
+
+        std::vector<std::size_t> distinctOf(hands.size()), representatives;
+
+        for (decltype(order.size()) i(0); i < order.size(); ++i)
+        {
+            if (!i || canonical[order[i]] != canonical[order[i - 1]]) representatives.push_back(order[i]);
+
+            distinctOf[order[i]] = representatives.size() - 1;
+        }
+
+        canonical.clear();
+
+        //
+        // 3. solve each distinct hand once, in sorted order
+        //
+        std::vector<batch_result> distinctResults(representatives.size());
+
+        {
+            table_cache cache(options.countOnly ? options.cacheCapacity : 0);
+
+            std::atomic<std::size_t> next{0};
+
+            std::vector<std::thread> solvers;
+
+            for (unsigned i(0); i < solverCount; ++i) solvers.emplace_back([&]()
+            {
+                for (auto d = next.fetch_add(1, std::memory_order_relaxed); d < representatives.size(); d = next.fetch_add(1, std::memory_order_relaxed))
+                {
+                    distinctResults[d] = solveHand(hands[representatives[d]], options, cache);
+                }
+            });
+
+            for (auto &t : solvers) t.join();
+        }
+
+        //
+        // 4. fan the results back out, in input order
+        //
+        runPipeline(output, options, 1, [&hands](unsigned, auto &emit)
+        {
+            for (decltype(hands.size()) sequence(0); sequence < hands.size(); ++sequence) emit(sequence, hands[sequence]);
+        },
+        [&distinctOf, &distinctResults](const batch_hand &hand)
+        {
+            return distinctResults[distinctOf[hand.sequence]];
+        });
+    }
+
+    /// \brief runs the pipeline, deduplicating the hands first if the options ask for it
+    template<class Produce>
+    void runHands(std::FILE *output, const batch_options &options, const unsigned parserCount, Produce &&produce)
+    {
+        if (options.deduplicate)
+        {
+            runDeduplicated(output, options, parserCount, std::forward<Produce>(produce));
+
+            return;
+        }
+
+        table_cache cache(options.countOnly ? options.cacheCapacity : 0);
+
+        runPipeline(output, options, parserCount, std::forward<Produce>(produce), [&options, &cache](const batch_hand &hand)
+        {
+            return solveHand(hand.input, options, cache);
+        });
+    }
+}
+
+void runBatch(std::istream &input, std::FILE *output, const batch_options &options)
+{
+    runHands(output, options, 1, [&input](unsigned, auto &emit)
+    {
+        std::string line;
+
+        std::size_t sequence(0), lineNumber(0);
+
+        input_collection_type hand;
+
+        while (std::getline(input, line))
+        {
+            if (parseHand(line.data(), line.data() + line.size(), ++lineNumber, hand)) emit(sequence++, hand);
+        }
+    });
+}
+
+void runBatch(const std::string &path, std::FILE *output, const batch_options &options)
+{
+    const mapped_file file(path, true);
+
+    if (!file.mapped())
+    {
+        // pipes, FIFOs and process substitutions have no size to map: they are read line by line
+        std::ifstream stream(path, std::ios::binary);
+
+        if (!stream) throw std::runtime_error(std::string("could not open batch file: ") + path);
+
+        runBatch(stream, output, options);
+
+        return;
+    }
+
+    const auto chunks = splitMappedInput(file.begin(), file.end());
+
+    const unsigned solverCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    const unsigned parserCount = std::max(1u, std::min<unsigned>(solverCount / 4, static_cast<unsigned>(chunks.size())));
+
+    std::atomic<std::size_t> nextChunk{0};
+
+    runHands(output, options, parserCount, [&chunks, &nextChunk](unsigned, auto &emit)
+    {
+        input_collection_type hand;
+
+        for (auto c = nextChunk.fetch_add(1, std::memory_order_relaxed); c < chunks.size(); c = nextChunk.fetch_add(1, std::memory_order_relaxed))
+        {
+            auto line = chunks[c].firstLine;
+
+            auto sequence = chunks[c].firstSequence;
+
+            for (const char *it = chunks[c].begin, *end = chunks[c].end; it != end; ++line)
+            {
+                const auto *newline = static_cast<const char *>(std::memchr(it, '\n', end - it));
+
+                const char *lineEnd = newline ? newline : end;
+
+                if (parseHand(it, lineEnd, line, hand)) emit(sequence++, hand);
+
+                it = newline ? newline + 1 : end;
+            }
+        }
+    });
+}
+
+void runCensus(const std::size_t size, const int low, const int high, std::FILE *output, const batch_options &options)
+{
+    if (!size || low > high) throw std::runtime_error("runCensus: the census is empty");
+
+    const multiset_index hands(size, low, high);
+
+    auto censusOptions = options;
+
+    censusOptions.hands = &hands;
+
+    runHands(output, censusOptions, 1, [size, low, high](unsigned, auto &emit)
+    {
+        std::vector<int> hand(size, low);
+
+        input_collection_type input;
+
+        for (std::size_t sequence(0);; ++sequence)
+        {
+            input.assign(hand.begin(), hand.end());
+
+            emit(sequence, input);
+
+            // next non-decreasing sequence: increment the last value below high, resetting those after it to its new value
+            auto i = size;
+
+            while (i > 0 && hand[i - 1] == high) --i;
+
+            if (!i) break;
+
+            const auto value = ++hand[i - 1];
+
+            std::fill(hand.begin() + i, hand.end(), value);
+        }
+    });
+}
@@ -0,0 +1,34 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <completion.h>
+#include <table_cache.h>
+
+#include <limits>
+
+std::vector<completion> findCompletions(const input_type targetNumber, const input_collection_type &partial, const input_collection_type &candidates)
+{
+    if (partial.size() + 1 > solution::max_operands) throw std::runtime_error("findCompletions: input set is too large");
+
+    table_cache cache(std::numeric_limits<std::size_t>::max());
+
+    // tables of the partial hand, shared by every candidate. Candidate tables are never shared, so they are not kept
+    const expression_tables shared(partial, true, solution::max_operands, &cache);
+
+    cache.freeze();
+
+    std::vector<completion> output;
+
+    output.reserve(candidates.size());
+
+    input_collection_type hand(partial);
+
+    hand.push_back(0);
+
+    for (const auto candidate : candidates)
+    {
+        hand.back() = candidate;
+
+        output.push_back({candidate, expression_tables(hand, false, solution::max_operands, &cache).count(targetNumber)});
+    }
+
+    return output;
+}
@@ -0,0 +1,78 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <coverage.h>
+#include <expression_tables.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    static constexpr std::uint64_t MAXIMUM_RANGE = std::uint64_t(1) << 24; //!< integers in a range: a bitmap of 2 MiB
+
+    static constexpr input_type TWO_TO_63 = 9223372036854775808.0;
+}
+
+bool coverage::reachable(const std::int64_t target) const
+{
+    if (target < low || target > high) return false;
+
+    const auto bit = static_cast<std::uint64_t>(target - low);
+
+    return bitmap[bit / 64] >> (bit % 64) & 1;
+}
+
+coverage findCoverage(input_collection_type input, const std::int64_t low, const std::int64_t high)
+{
+    if (low > high) throw std::runtime_error("findCoverage: the range is empty");
+
+    // the difference is taken in unsigned arithmetic, where it cannot overflow once low <= high
+    const auto width = static_cast<std::uint64_t>(high) - static_cast<std::uint64_t>(low);
+
+    if (width >= MAXIMUM_RANGE)
+    {
+        std::stringstream ss;
+
+        ss << "findCoverage: the range [" << low << ", " << high << "] holds more than " << MAXIMUM_RANGE << " integers";
+
+        throw std::runtime_error(ss.str());
+    }
+
+    const expression_tables tables(std::move(input), true);
+
+    coverage output{low, high, tables.input(), std::vector<std::uint64_t>(static_cast<std::size_t>(width / 64 + 1), 0), {}};
+
+    if (tables.input().empty()) return output;
+
+    const auto &values = tables.table(tables.full()).values;
+
+    const auto lowKey = valueKey(static_cast<input_type>(low)), highKey = valueKey(static_cast<input_type>(high));
+
+    // -0 sorts before +0: a range starting at 0 must include both
+    const auto first = std::lower_bound(values.begin(), values.end(), low ? lowKey : valueKey(-0.0), [](const input_type v, const std::uint64_t k) { return valueKey(v) < k; });
+
+    for (auto it = first; it != values.end() && valueKey(*it) <= highKey; ++it)
+    {
+        const auto value = *it;
+
+        // low and high may have been rounded outward on conversion, and 2^63 does not convert back
+        if (value != std::floor(value) || value < -TWO_TO_63 || value >= TWO_TO_63) continue;
+
+        const auto integer = static_cast<std::int64_t>(value);
+
+        if (integer < low || integer > high) continue;
+
+        const auto bit = static_cast<std::uint64_t>(integer) - static_cast<std::uint64_t>(low);
+
+        auto &word = output.bitmap[bit / 64];
+
+        if (word >> (bit % 64) & 1) continue; // the other zero
+
+        word |= std::uint64_t(1) << (bit % 64);
+
+        output.witnesses.push_back(tables.unrank(value, 0));
+    }
+
+    return output;
+}
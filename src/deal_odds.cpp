@@ -0,0 +1,166 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <deal_odds.h>
+#include <expression_tables.h>
+#include <table_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    static constexpr std::size_t CACHE_CAPACITY = std::size_t(1) << 24;
+
+    static constexpr std::size_t BLOCK_SIZE = 64; //!< consecutive hands solved by one thread, so they share sub-multisets
+
+    /// \brief a * b, throwing if it does not fit: the deck is too large to count its deals
+    std::uint64_t multiply(const std::uint64_t a, const std::uint64_t b)
+    {
+        if (a && b > std::numeric_limits<std::uint64_t>::max() / a)
+        {
+            std::stringstream ss;
+
+            ss << "findDealOdds: a count of deals, " << a << " * " << b << ", does not fit in 64 bits";
+
+            throw std::runtime_error(ss.str());
+        }
+
+        return a * b;
+    }
+
+    /// \brief number of ways to choose k of n, throwing if it does not fit
+    std::uint64_t choose(const std::uint64_t n, std::uint64_t k)
+    {
+        if (k > n) return 0;
+
+        k = std::min(k, n - k);
+
+        std::uint64_t output(1);
+
+        // output * (n - k + i) is divisible by i, as a product of i consecutive integers is divisible by i!. Dividing by the common
+        // factor first keeps the intermediate no larger than the result
+        for (std::uint64_t i(1); i <= k; ++i)
+        {
+            const auto common = std::gcd(output, i);
+
+            output = multiply(output / common, (n - k + i) / (i / common));
+        }
+
+        return output;
+    }
+}
+
+double deal_odds::probability() const
+{
+    return deals ? static_cast<double>(solvableDeals) / deals : 0;
+}
+
+deal_odds findDealOdds(const input_type targetNumber, const std::size_t cards, const deck &d, unsigned threads)
+{
+    const auto deckSize = d.low > d.high ? 0 : multiply(d.copies, static_cast<std::uint64_t>(static_cast<std::int64_t>(d.high) - d.low + 1));
+
+    if (!cards || cards > solution::max_operands || !deckSize || cards > deckSize)
+    {
+        std::stringstream ss;
+
+        ss << "findDealOdds: deals of " << cards << " cards from " << d.copies << " copies of [" << d.low << ", " << d.high << "] are not supported";
+
+        throw std::runtime_error(ss.str());
+    }
+
+    const auto deals = choose(deckSize, cards);
+
+    // every hand that can be dealt, in lexicographic order, with the number of deals producing it
+    std::vector<input_collection_type> hands;
+
+    std::vector<std::uint64_t> weights;
+
+    {
+        std::vector<int> hand(cards, d.low);
+
+        const auto next = [&]()
+        {
+            auto i = cards;
+
+            while (i > 0 && hand[i - 1] == d.high) --i;
+
+            if (!i) return false;
+
+            const auto value = ++hand[i - 1];
+
+            std::fill(hand.begin() + i, hand.end(), value);
+
+            return true;
+        };
+
+        do
+        {
+            std::uint64_t weight(1);
+
+            for (std::size_t i(0), j(0); i < cards; i = j)
+            {
+                while (j < cards && hand[j] == hand[i]) ++j;
+
+                weight = multiply(weight, choose(d.copies, j - i));
+            }
+
+            if (!weight) continue; // more copies of a value than the deck holds
+
+            hands.emplace_back(hand.begin(), hand.end());
+
+            weights.push_back(weight);
+        }
+        while (next());
+    }
+
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    table_cache cache(CACHE_CAPACITY);
+
+    std::atomic<std::size_t> nextBlock{0};
+
+    std::atomic<std::uint64_t> solvableHands{0}, solvableDeals{0};
+
+    const auto solve = [&]()
+    {
+        std::uint64_t localHands(0), localDeals(0);
+
+        for (std::size_t begin; (begin = nextBlock.fetch_add(BLOCK_SIZE, std::memory_order_relaxed)) < hands.size();)
+        {
+            for (auto i = begin; i < std::min(begin + BLOCK_SIZE, hands.size()); ++i)
+            {
+                if (!isReachable(targetNumber, hands[i], &cache)) continue;
+
+                ++localHands;
+
+                localDeals += weights[i];
+            }
+        }
+
+        solvableHands += localHands;
+
+        solvableDeals += localDeals;
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned i(1); i < threads; ++i) workers.emplace_back(solve);
+
+    solve();
+
+    for (auto &worker : workers) worker.join();
+
+    deal_odds output;
+
+    output.hands = hands.size();
+    output.solvableHands = solvableHands;
+    output.deals = deals;
+    output.solvableDeals = solvableDeals;
+
+    return output;
+}
@@ -0,0 +1,133 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <expression.h>
+
+#include <charconv>
+
+namespace
+{
+    /// \brief expression tree rebuilt from a solution's steps. Leaves are operands, the root is the last node
+    struct expression_tree
+    {
+        static constexpr std::uint8_t leaf = 0xFF;
+
+        struct node
+        {
+            std::uint8_t left; //!< leaf, or index of the left child
+            std::uint8_t right; //!< operand index for leaves, otherwise index of the right child
+
+            Operation operation;
+        };
+
+        std::array<node, solution::max_operands * 2 - 1> nodes;
+
+        std::uint8_t size = 0;
+
+        explicit expression_tree(const solution &s)
+        {
+            std::array<std::uint8_t, solution::max_operands> working;
+
+            for (std::uint8_t i(0); i < s.size; ++i)
+            {
+                nodes[size] = {leaf, s.operands[i], Operation::Addition};
+
+                working[i] = size++;
+            }
+
+            for (std::uint8_t i(0), workingSize(s.size); i + 1 < s.size; ++i, --workingSize)
+            {
+                const auto &step = s.steps[i];
+
+                nodes[size] = {working[step.position], working[step.position + 1], step.operation};
+
+                working[step.position] = size++;
+
+                std::copy(working.begin() + step.position + 2, working.begin() + workingSize, working.begin() + step.position + 1);
+            }
+        }
+    };
+
+    int precedence(const expression_tree::node &n)
+    {
+        if (n.left == expression_tree::leaf) return 3;
+
+        return n.operation == Operation::Addition || n.operation == Operation::Subtraction ? 1 : 2;
+    }
+}
+
+infix_renderer::infix_renderer(const input_collection_type &input)
+{
+    if (input.size() > solution::max_operands) throw std::runtime_error("infix_renderer: input set is too large");
+
+    for (decltype(input.size()) i(0); i < input.size(); ++i)
+    {
+        auto &operand = m_Operands[i];
+
+        const auto result = std::to_chars(operand.characters.data(), operand.characters.data() + operand.characters.size(), input[i]);
+
+        operand.size = static_cast<std::uint8_t>(result.ptr - operand.characters.data());
+        operand.negative = operand.characters[0] == '-';
+    }
+}
+
+void infix_renderer::write(std::string &buffer, const solution &s) const
+{
+    if (!s.size) return;
+
+    const expression_tree tree(s);
+
+    const auto writeNode = [&](const auto &self, const std::uint8_t index, const bool parenthesize) -> void
+    {
+        const auto &n = tree.nodes[index];
+
+        if (n.left == expression_tree::leaf)
+        {
+            const auto &operand = m_Operands[n.right];
+
+            if (operand.negative && parenthesize) buffer += '(';
+
+            buffer.append(operand.characters.data(), operand.size);
+
+            if (operand.negative && parenthesize) buffer += ')';
+
+            return;
+        }
+
+        // operands are always asked to parenthesize: they only do so if they are negative. A right child of equal precedence keeps its
+        // parentheses even under + and *, so the text parses back, left to right, into this tree: different trees never print alike,
+        // and the text evaluates in floating point as the tree did
+        const auto needsParentheses = [&n](const expression_tree::node &child, const bool isRight)
+        {
+            const auto p = precedence(n), childPrecedence = precedence(child);
+
+            return child.left == expression_tree::leaf
+                || childPrecedence < p
+                || (isRight && childPrecedence == p);
+        };
+
+        if (parenthesize) buffer += '(';
+
+        self(self, n.left, needsParentheses(tree.nodes[n.left], false));
+
+        buffer += Operation_ToChar(n.operation);
+
+        self(self, n.right, needsParentheses(tree.nodes[n.right], true));
+
+        if (parenthesize) buffer += ')';
+    };
+
+    writeNode(writeNode, tree.size - 1, false);
+}
+
+void writeInfix(std::string &buffer, const input_collection_type &input, const solution &s)
+{
+    infix_renderer(input).write(buffer, s);
+}
+
+void writeNumber(std::string &buffer, const input_type value)
+{
+    std::array<char, 32> characters;
+
+    const auto result = std::to_chars(characters.data(), characters.data() + characters.size(), value);
+
+    buffer.append(characters.data(), result.ptr);
+}
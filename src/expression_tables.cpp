@@ -0,0 +1,680 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <expression_tables.h>
+#include <robin_hood_map.h>
+#include <table_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace
+{
+    static constexpr std::uint64_t SIGN_BIT = std::uint64_t(1) << 63;
+
+    /// \brief zeros and infinities, the values at which the operations stop being monotonic
+    bool isSpecial(const input_type value)
+    {
+        return value == 0 || std::isinf(value);
+    }
+
+    /// \brief [first, last) of the entries b in [begin, end) for which key(f(b)) == key, given f monotonic over [begin, end)
+    template<class F>
+    std::pair<std::size_t, std::size_t> equalRange(const std::vector<input_type> &values, const std::size_t begin, const std::size_t end, F &&f, const std::uint64_t key)
+    {
+        if (begin == end) return {begin, begin};
+
+        const bool increasing = valueKey(f(values[begin])) <= valueKey(f(values[end - 1]));
+
+        const auto first = std::partition_point(values.begin() + begin, values.begin() + end, [&](const input_type b)
+        {
+            const auto k = valueKey(f(b));
+
+            return increasing ? k < key : k > key;
+        });
+
+        const auto last = std::partition_point(first, values.begin() + end, [&](const input_type b)
+        {
+            const auto k = valueKey(f(b));
+
+            return increasing ? k <= key : k >= key;
+        });
+
+        return {static_cast<std::size_t>(first - values.begin()), static_cast<std::size_t>(last - values.begin())};
+    }
+
+    /// \brief the keys a target matches: both zeros compare equal to a zero target, NaN matches nothing
+    std::vector<std::uint64_t> targetKeys(const input_type target)
+    {
+        if (std::isnan(target)) return {};
+
+        if (target == 0) return {valueKey(-0.0), valueKey(0.0)};
+
+        return {valueKey(target)};
+    }
+}
+
+std::uint64_t valueKey(const input_type value)
+{
+    std::uint64_t bits;
+
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    return bits & SIGN_BIT ? ~bits : bits | SIGN_BIT;
+}
+
+input_type valueFromKey(const std::uint64_t key)
+{
+    const std::uint64_t bits = key & SIGN_BIT ? key ^ SIGN_BIT : ~key;
+
+    input_type value;
+
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+std::size_t value_table::find(const std::uint64_t key) const
+{
+    const auto it = std::lower_bound(values.begin(), values.end(), key, [](const input_type v, const std::uint64_t k) { return valueKey(v) < k; });
+
+    return it != values.end() && valueKey(*it) == key ? it - values.begin() : values.size();
+}
+
+/// \brief a set of expressions over a sub-multiset: those combining any expression for values[a] of table left
+/// with any expression for values[first, last) of table right
+struct expression_tables::combination
+{
+    std::size_t left, a;
+
+    std::size_t right, first, last;
+
+    Operation operation;
+};
+
+template<class Visit>
+bool expression_tables::forEachCombination(const std::size_t subset, const std::uint64_t key, Visit &&visit) const
+{
+    const auto digits = m_Distinct.size();
+
+    std::vector<std::size_t> limit(digits), digit(digits, 0);
+
+    for (std::size_t i(0); i < digits; ++i) limit[i] = subset / m_Stride[i] % (m_Multiplicity[i] + 1);
+
+    // every non-empty proper sub-multiset of subset, in increasing index order
+    for (std::size_t left(0);;)
+    {
+        std::size_t i(0);
+
+        for (; i < digits && digit[i] == limit[i]; ++i)
+        {
+            left -= digit[i] * m_Stride[i];
+
+            digit[i] = 0;
+        }
+
+        if (i == digits) return true;
+
+        ++digit[i];
+
+        left += m_Stride[i];
+
+        if (left == subset) continue;
+
+        const auto right = subset - left;
+
+        const auto &l = table(left), &r = table(right);
+
+        // the finite non-zero values of each sign are searched, the special values around them are tried directly
+        const std::size_t negatives = std::partition_point(r.values.begin(), r.values.end(), [](const input_type v) { return v == -std::numeric_limits<input_type>::infinity(); }) - r.values.begin();
+
+        const std::size_t negativeEnd = std::partition_point(r.values.begin() + negatives, r.values.end(), [](const input_type v) { return v < 0; }) - r.values.begin();
+
+        const std::size_t positives = std::partition_point(r.values.begin() + negativeEnd, r.values.end(), [](const input_type v) { return v == 0; }) - r.values.begin();
+
+        const std::size_t positiveEnd = std::partition_point(r.values.begin() + positives, r.values.end(), [](const input_type v) { return v != std::numeric_limits<input_type>::infinity(); }) - r.values.begin();
+
+        const std::size_t segments[][2] = {{negatives, negativeEnd}, {positives, positiveEnd}};
+
+        for (std::size_t o(0); o < Operation_Count; ++o)
+        {
+            const auto operation = static_cast<Operation>(o);
+
+            if (!m_Filter.allows(operation)) continue;
+
+            for (std::size_t a(0); a < l.values.size(); ++a)
+            {
+                const auto lhs = l.values[a];
+
+                const auto f = [lhs, operation](const input_type rhs) { return Operation_PerformOperation(lhs, rhs, operation); };
+
+                const auto visitSingle = [&](const std::size_t b)
+                {
+                    const auto value = f(r.values[b]);
+
+                    if (std::isnan(value) || valueKey(value) != key) return true;
+
+                    return visit(combination{left, a, right, b, b + 1, operation});
+                };
+
+                if (isSpecial(lhs))
+                {
+                    for (std::size_t b(0); b < r.values.size(); ++b) if (!visitSingle(b)) return false;
+
+                    continue;
+                }
+
+                for (std::size_t b(0); b < negatives; ++b) if (!visitSingle(b)) return false;
+
+                for (std::size_t s(0); s < 2; ++s)
+                {
+                    const auto range = equalRange(r.values, segments[s][0], segments[s][1], f, key);
+
+                    if (range.first != range.second && !visit(combination{left, a, right, range.first, range.second, operation})) return false;
+
+                    if (!s) for (auto b = negativeEnd; b < positives; ++b) if (!visitSingle(b)) return false;
+                }
+
+                for (auto b = positiveEnd; b < r.values.size(); ++b) if (!visitSingle(b)) return false;
+            }
+        }
+    }
+}
+
+void expression_tables::buildTable(const std::size_t subset, const unsigned threads)
+{
+    const auto digits = m_Distinct.size();
+
+    std::vector<std::size_t> limit(digits), digit(digits, 0);
+
+    for (std::size_t i(0); i < digits; ++i) limit[i] = subset / m_Stride[i] % (m_Multiplicity[i] + 1);
+
+    // every proper non-empty part of subset, as the left operand of a split
+    std::vector<std::size_t> parts;
+
+    for (std::size_t left(0);;)
+    {
+        std::size_t i(0);
+
+        for (; i < digits && digit[i] == limit[i]; ++i)
+        {
+            left -= digit[i] * m_Stride[i];
+
+            digit[i] = 0;
+        }
+
+        if (i == digits) break;
+
+        ++digit[i];
+
+        left += m_Stride[i];
+
+        if (left != subset) parts.push_back(left);
+    }
+
+    using entry_list = std::vector<std::pair<std::uint64_t, expression_count>>;
+
+    // the values of the splits first, first + stride, ..., sorted by key
+    const auto combine = [this, subset, &parts](const std::size_t first, const std::size_t stride)
+    {
+        robin_hood_map<expression_count> buffer;
+
+        for (auto p = first; p < parts.size(); p += stride)
+        {
+            const auto &l = table(parts[p]), &r = table(subset - parts[p]);
+
+            for (std::size_t a(0); a < l.values.size(); ++a)
+            {
+                for (std::size_t b(0); b < r.values.size(); ++b)
+                {
+                    const auto weight = l.counts[a] * r.counts[b];
+
+                    for (std::size_t o(0); o < Operation_Count; ++o)
+                    {
+                        if (!m_Filter.allows(static_cast<Operation>(o))) continue;
+
+                        const auto value = Operation_PerformOperation(l.values[a], r.values[b], static_cast<Operation>(o));
+
+                        if (!std::isnan(value) && m_Filter.accepts(value)) buffer[valueKey(value)] += weight;
+                    }
+                }
+            }
+        }
+
+        entry_list entries;
+
+        entries.reserve(buffer.size());
+
+        buffer.forEach([&entries](const std::uint64_t key, const expression_count count) { entries.emplace_back(key, count); });
+
+        std::sort(entries.begin(), entries.end());
+
+        return entries;
+    };
+
+    const auto workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, parts.size()));
+
+    // each worker tabulates its own share of the splits, the sorted shares are merged afterwards
+    std::vector<entry_list> shares(workers);
+
+    {
+        std::vector<std::thread> pool;
+
+        for (std::size_t w(1); w < workers; ++w) pool.emplace_back([&shares, &combine, w, workers]() { shares[w] = combine(w, workers); });
+
+        shares[0] = combine(0, workers);
+
+        for (auto &thread : pool) thread.join();
+    }
+
+    auto &entries = shares[0];
+
+    for (std::size_t w(1); w < workers; ++w)
+    {
+        entry_list merged;
+
+        merged.reserve(entries.size() + shares[w].size());
+
+        std::merge(entries.begin(), entries.end(), shares[w].begin(), shares[w].end(), std::back_inserter(merged));
+
+        entries.clear();
+
+        for (const auto &e : merged)
+        {
+            if (!entries.empty() && entries.back().first == e.first) entries.back().second += e.second;
+            else entries.push_back(e);
+        }
+
+        shares[w] = {};
+    }
+
+    auto output = std::make_shared<value_table>();
+
+    output->values.reserve(entries.size());
+    output->counts.reserve(entries.size());
+    output->prefix.reserve(entries.size() + 1);
+
+    output->prefix.push_back(0);
+
+    for (const auto &entry : entries)
+    {
+        output->values.push_back(valueFromKey(entry.first));
+        output->counts.push_back(entry.second);
+        output->prefix.push_back(output->prefix.back() + entry.second);
+    }
+
+    m_Tables[subset] = std::move(output);
+}
+
+expression_tables::expression_tables(input_collection_type input, const bool includeFull, const std::size_t tableLimit, table_cache *cache, const expression_filter filter,
+    const unsigned threads)
+: m_Input(std::move(input))
+, m_Filter(filter)
+{
+    if (m_Input.size() > solution::max_operands) throw std::runtime_error("expression_tables: input set is too large");
+
+    std::sort(m_Input.begin(), m_Input.end());
+
+    for (decltype(m_Input.size()) i(0); i < m_Input.size(); ++i)
+    {
+        if (!i || m_Input[i] != m_Input[i - 1])
+        {
+            m_Distinct.push_back(m_Input[i]);
+            m_Multiplicity.push_back(0);
+            m_FirstIndex.push_back(i);
+        }
+
+        ++m_Multiplicity.back();
+    }
+
+    std::size_t total(1);
+
+    for (const auto multiplicity : m_Multiplicity)
+    {
+        m_Stride.push_back(total);
+
+        total *= multiplicity + 1;
+    }
+
+    m_Full = total - 1;
+
+    m_Size.resize(total);
+    m_Tables.resize(total);
+
+    for (std::size_t subset(0); subset < total; ++subset)
+    {
+        std::size_t size(0);
+
+        for (std::size_t i(0); i < m_Distinct.size(); ++i) size += subset / m_Stride[i] % (m_Multiplicity[i] + 1);
+
+        m_Size[subset] = static_cast<std::uint8_t>(size);
+    }
+
+    for (std::size_t i(0); i < m_Distinct.size(); ++i)
+    {
+        m_Tables[m_Stride[i]] = std::make_shared<const value_table>(value_table{{m_Distinct[i]}, {1}, {0, 1}});
+    }
+
+    // builds the table of subset with the given number of threads, or shares it from the cache
+    const auto prepare = [this, cache](const std::size_t subset, const unsigned tableThreads)
+    {
+        if (!cache)
+        {
+            buildTable(subset, tableThreads);
+
+            return;
+        }
+
+        table_cache::key_type key{std::uint64_t(m_Filter.operations) | std::uint64_t(m_Filter.integers) << 8}; // tables of different filters differ
+
+        for (std::size_t i(0); i < m_Distinct.size(); ++i) key.insert(key.end(), subset / m_Stride[i] % (m_Multiplicity[i] + 1), valueKey(m_Distinct[i]));
+
+        if (!(m_Tables[subset] = cache->find(key)))
+        {
+            buildTable(subset, tableThreads);
+
+            cache->insert(key, m_Tables[subset]);
+        }
+    };
+
+    //
+    // tables depend only on tables of fewer operands: the sub-multisets of one size are a wavefront, built in parallel
+    //
+    std::vector<std::size_t> layer;
+
+    for (std::size_t size(2), last(std::min(includeFull ? m_Input.size() : m_Input.size() - 1, tableLimit)); size <= last; ++size)
+    {
+        layer.clear();
+
+        for (std::size_t subset(0); subset < total; ++subset) if (m_Size[subset] == size) layer.push_back(subset);
+
+        const auto workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, layer.size()));
+
+        if (workers == 1)
+        {
+            for (const auto subset : layer) prepare(subset, threads);
+
+            continue;
+        }
+
+        // each worker builds whole tables, into slots no other worker touches. Threads left over split the splits of each table
+        const auto tableThreads = static_cast<unsigned>(std::max<std::size_t>(1, threads / workers));
+
+        std::atomic<std::size_t> next{0};
+
+        const auto work = [&]()
+        {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < layer.size();) prepare(layer[i], tableThreads);
+        };
+
+        std::vector<std::thread> pool;
+
+        for (std::size_t w(1); w < workers; ++w) pool.emplace_back(work);
+
+        work();
+
+        for (auto &thread : pool) thread.join();
+    }
+}
+
+const input_collection_type &expression_tables::input() const
+{
+    return m_Input;
+}
+
+std::size_t expression_tables::full() const
+{
+    return m_Full;
+}
+
+std::size_t expression_tables::size() const
+{
+    return m_Tables.size();
+}
+
+std::size_t expression_tables::operandCount(const std::size_t subset) const
+{
+    return m_Size[subset];
+}
+
+bool expression_tables::includes(const std::size_t subset, const std::size_t part) const
+{
+    for (std::size_t i(0); i < m_Distinct.size(); ++i)
+    {
+        const auto radix = m_Multiplicity[i] + 1;
+
+        if (part / m_Stride[i] % radix > subset / m_Stride[i] % radix) return false;
+    }
+
+    return true;
+}
+
+const value_table &expression_tables::table(const std::size_t subset) const
+{
+    static const value_table empty;
+
+    return m_Tables[subset] ? *m_Tables[subset] : empty;
+}
+
+expression_count expression_tables::count(const input_type target) const
+{
+    return count(m_Full, target);
+}
+
+expression_count expression_tables::count(const std::size_t subset, const input_type target) const
+{
+    expression_count output(0);
+
+    if (m_Input.empty()) return output;
+
+    const auto &t = table(subset);
+
+    for (const auto key : targetKeys(target))
+    {
+        if (m_Size[subset] == 1 || !t.values.empty())
+        {
+            if (const auto i = t.find(key); i < t.values.size()) output += t.counts[i];
+
+            continue;
+        }
+
+        forEachCombination(subset, key, [this, &output](const combination &c)
+        {
+            const auto &l = table(c.left), &r = table(c.right);
+
+            output += l.counts[c.a] * (r.prefix[c.last] - r.prefix[c.first]);
+
+            return true;
+        });
+    }
+
+    return output;
+}
+
+bool expression_tables::reaches(const input_type target) const
+{
+    return reaches(m_Full, target);
+}
+
+bool expression_tables::reaches(const std::size_t subset, const input_type target) const
+{
+    if (m_Input.empty()) return false;
+
+    const auto &t = table(subset);
+
+    for (const auto key : targetKeys(target))
+    {
+        if (m_Size[subset] == 1 || !t.values.empty())
+        {
+            if (t.find(key) < t.values.size()) return true;
+
+            continue;
+        }
+
+        // every combination visited produces the target, so the first one ends the search
+        if (!forEachCombination(subset, key, [](const combination &) { return false; })) return true;
+    }
+
+    return false;
+}
+
+void expression_tables::unrank(const std::size_t subset, const std::uint64_t key, expression_count rank, std::uint8_t position, std::vector<std::size_t> &used, solution &s) const
+{
+    if (m_Size[subset] == 1)
+    {
+        const auto group = std::find(m_Stride.begin(), m_Stride.end(), subset) - m_Stride.begin();
+
+        s.operands[s.size++] = static_cast<std::uint8_t>(m_FirstIndex[group] + used[group]++);
+
+        return;
+    }
+
+    const bool found = !forEachCombination(subset, key, [&](const combination &c)
+    {
+        const auto &l = table(c.left), &r = table(c.right);
+
+        const auto rightCount = r.prefix[c.last] - r.prefix[c.first];
+
+        const auto weight = l.counts[c.a] * rightCount;
+
+        if (rank >= weight)
+        {
+            rank -= weight;
+
+            return true;
+        }
+
+        const auto leftRank = rank / rightCount;
+
+        auto rightRank = rank % rightCount;
+
+        const auto b = static_cast<std::size_t>(std::upper_bound(r.prefix.begin() + c.first + 1, r.prefix.begin() + c.last + 1, r.prefix[c.first] + rightRank) - (r.prefix.begin() + 1));
+
+        rightRank -= r.prefix[b] - r.prefix[c.first];
+
+        unrank(c.left, valueKey(l.values[c.a]), leftRank, position, used, s);
+
+        unrank(c.right, valueKey(r.values[b]), rightRank, position + 1, used, s);
+
+        // steps taken so far are the operands placed so far less the position + 1 working values they have been reduced to
+        s.steps[s.size - position - 2] = {position, c.operation};
+
+        return false;
+    });
+
+    if (!found) throw std::runtime_error("expression_tables::unrank: rank out of range");
+}
+
+solution expression_tables::unrank(const input_type target, const expression_count rank) const
+{
+    return unrank(m_Full, target, rank);
+}
+
+solution expression_tables::unrank(const std::size_t subset, const input_type target, expression_count rank) const
+{
+    solution s;
+
+    s.size = 0;
+
+    std::vector<std::size_t> used(m_Distinct.size(), 0);
+
+    for (const auto key : targetKeys(target))
+    {
+        expression_count count(0);
+
+        const auto &t = table(subset);
+
+        if (m_Size[subset] == 1 || !t.values.empty())
+        {
+            if (const auto i = t.find(key); i < t.values.size()) count = t.counts[i];
+        }
+        else forEachCombination(subset, key, [this, &count](const combination &c)
+        {
+            count += table(c.left).counts[c.a] * (table(c.right).prefix[c.last] - table(c.right).prefix[c.first]);
+
+            return true;
+        });
+
+        if (rank < count)
+        {
+            unrank(subset, key, rank, 0, used, s);
+
+            return s;
+        }
+
+        rank -= count;
+    }
+
+    throw std::runtime_error("expression_tables::unrank: rank out of range");
+}
+
+bool isReachable(const input_type targetNumber, input_collection_type input, table_cache *cache, const expression_filter filter)
+{
+    return expression_tables(std::move(input), false, solution::max_operands, cache, filter).reaches(targetNumber);
+}
+
+solution_set sampleSolution(const input_type targetNumber, input_collection_type input, const std::uint64_t seed, expression_count *count)
+{
+    const expression_tables tables(std::move(input));
+
+    solution_set output{targetNumber, tables.input(), {}};
+
+    const auto total = tables.count(targetNumber);
+
+    if (count) *count = total;
+
+    if (total)
+    {
+        std::mt19937_64 generator(seed);
+
+        output.solutions.push_back(tables.unrank(targetNumber, std::uniform_int_distribution<expression_count>(0, total - 1)(generator)));
+    }
+
+    return output;
+}
+
+namespace
+{
+    /// \brief every non-empty sub-multiset, by increasing size and then increasing index
+    std::vector<std::size_t> subsetsBySize(const expression_tables &tables)
+    {
+        std::vector<std::size_t> output;
+
+        for (std::size_t subset(1); subset < tables.size(); ++subset) output.push_back(subset);
+
+        std::stable_sort(output.begin(), output.end(), [&tables](const std::size_t a, const std::size_t b) { return tables.operandCount(a) < tables.operandCount(b); });
+
+        return output;
+    }
+}
+
+solution_set findSubsetSolutions(const input_type targetNumber, input_collection_type input)
+{
+    const expression_tables tables(std::move(input));
+
+    solution_set output{targetNumber, tables.input(), {}};
+
+    for (const auto subset : subsetsBySize(tables))
+    {
+        const auto count = tables.count(subset, targetNumber);
+
+        for (expression_count rank(0); rank < count; ++rank) output.solutions.push_back(tables.unrank(subset, targetNumber, rank));
+    }
+
+    return output;
+}
+
+expression_count countSubsetSolutions(const input_type targetNumber, input_collection_type input)
+{
+    const expression_tables tables(std::move(input));
+
+    expression_count output(0);
+
+    for (std::size_t subset(1); subset < tables.size(); ++subset) output += tables.count(subset, targetNumber);
+
+    return output;
+}
@@ -0,0 +1,153 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <generator.h>
+#include <table_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    static constexpr std::size_t CACHE_CAPACITY = std::size_t(1) << 22;
+
+    static constexpr std::uint64_t ROUND_DRAWS = 1024; //!< draws tested in parallel between merges
+
+    /// \brief the seed of one draw: splitmix64 of the seed and the draw index
+    std::uint64_t mix(const std::uint64_t seed, const std::uint64_t draw)
+    {
+        auto z = seed + (draw + 1) * 0x9E3779B97F4A7C15ull;
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+        return z ^ (z >> 31);
+    }
+
+    static constexpr expression_filter WITHOUT_DIVISION{0xF & ~(1u << static_cast<unsigned>(Operation::Division)), false};
+
+    static constexpr expression_filter INTEGERS_ONLY{0xF, true};
+}
+
+std::vector<generated_hand> generateHands(const generator_options &options, std::uint64_t *candidates)
+{
+    if (!options.size || options.size > solution::max_operands || options.low > options.high)
+    {
+        std::stringstream ss;
+
+        ss << "generateHands: hands of " << options.size << " numbers in [" << options.low << ", " << options.high << "] are not supported";
+
+        throw std::runtime_error(ss.str());
+    }
+
+    const unsigned threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    // the filtered tables are keyed apart from the unfiltered ones, see table_cache.h
+    table_cache cache(CACHE_CAPACITY);
+
+    std::set<input_collection_type> seen; //!< hands drawn in earlier rounds, accepted or not
+
+    std::vector<generated_hand> output;
+
+    std::uint64_t drawn(0);
+
+    // draws are tested a round at a time in parallel, then kept in draw order, so the hands returned depend only on the seed
+    std::vector<input_collection_type> hands;
+
+    std::vector<std::optional<generated_hand>> accepted;
+
+    while (output.size() < options.count && drawn < options.maximumCandidates)
+    {
+        const auto roundSize = static_cast<std::size_t>(std::min<std::uint64_t>(ROUND_DRAWS, options.maximumCandidates - drawn));
+
+        hands.assign(roundSize, input_collection_type(options.size));
+
+        accepted.assign(roundSize, std::nullopt);
+
+        std::atomic<std::size_t> next{0};
+
+        const auto generate = [&]()
+        {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < roundSize;)
+            {
+                auto &hand = hands[i];
+
+                // each draw has its own generator, seeded from the seed and the draw index
+                std::mt19937_64 random(mix(options.seed, drawn + i));
+
+                std::uniform_int_distribution<int> number(options.low, options.high);
+
+                for (auto &n : hand) n = number(random);
+
+                std::sort(hand.begin(), hand.end());
+
+                if (seen.count(hand)) continue;
+
+                const auto reachable = isReachable(options.target, hand, &cache);
+
+                // every solution dividing, or passing through a fraction, is only asked of hands with a solution
+                if (!reachable && (options.minimumSolutions || options.requiresDivision || options.requiresFractions)) continue;
+
+                // solutions are counted before the other constraints only if their number is constrained beyond existence
+                const bool bounded = options.minimumSolutions > 1 || options.maximumSolutions != std::numeric_limits<expression_count>::max();
+
+                expression_count solutions(0);
+
+                if (reachable && bounded)
+                {
+                    solutions = expression_tables(hand, false, solution::max_operands, &cache).count(options.target);
+
+                    if (solutions < options.minimumSolutions || solutions > options.maximumSolutions) continue;
+                }
+
+                if (options.requiresDivision && isReachable(options.target, hand, &cache, WITHOUT_DIVISION)) continue;
+
+                if (options.requiresFractions && isReachable(options.target, hand, &cache, INTEGERS_ONLY)) continue;
+
+                if (reachable && !bounded) solutions = expression_tables(hand, false, solution::max_operands, &cache).count(options.target);
+
+                difficulty rating;
+
+                if (options.rateDifficulty) findSolutions(options.target, hand, &rating);
+
+                accepted[i] = generated_hand{hand, solutions, rating};
+            }
+        };
+
+        std::vector<std::thread> workers;
+
+        for (unsigned w(1); w < threadCount && w < roundSize; ++w) workers.emplace_back(generate);
+
+        generate();
+
+        for (auto &worker : workers) worker.join();
+
+        for (std::size_t i(0); i < roundSize; ++i)
+        {
+            ++drawn;
+
+            // a hand drawn again is not tested twice and not kept twice
+            if (!seen.insert(hands[i]).second || !accepted[i]) continue;
+
+            output.push_back(std::move(*accepted[i]));
+
+            if (output.size() == options.count) break;
+        }
+    }
+
+    if (candidates) *candidates = drawn;
+
+    std::sort(output.begin(), output.end(), [&options](const generated_hand &a, const generated_hand &b)
+    {
+        if (options.rateDifficulty && a.rating.score() != b.rating.score()) return a.rating.score() > b.rating.score();
+
+        return a.input < b.input;
+    });
+
+    return output;
+}
@@ -0,0 +1,42 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief verifies a player's infix answer for a hand without searching for solutions
+///
+/// The answer is parsed and evaluated in a single left to right pass, by precedence climbing,
+/// in exact rational arithmetic (see rational.h): 8/(3-8/3) is 24, although it is not in floating point.
+/// Answers nesting more than 256 parentheses are rejected as malformed, so no answer can exhaust the stack.
+/// Numbers, including the target, stand for the decimal fractions they are written as: 0.05+0.05 equals a target of 0.1.
+/// Its numbers must be the numbers of the hand, each used once. A number may only be negative at the start of the answer
+/// or of a parenthesized expression, as infix_renderer writes them, e.g. "5*(-1)"; there is no unary minus.
+///
+#ifndef N24_ANSWER_CHECK_H
+#define N24_ANSWER_CHECK_H
+
+#include <solver.h>
+
+#include <string>
+
+enum class answer_verdict
+{
+    correct,
+    malformed, //!< not an infix expression of +, -, *, / over numbers and parentheses
+    wrong_numbers, //!< its numbers are not the numbers of the hand
+    division_by_zero,
+    overflow, //!< too large to evaluate exactly
+    wrong_value, //!< a valid expression over the hand that does not equal the target
+};
+
+struct answer_check
+{
+    answer_verdict verdict;
+
+    std::size_t position = 0; //!< offset of the character at which a malformed or overflowing answer was rejected
+
+    /// \brief a sentence describing the verdict
+    std::string message() const;
+};
+
+/// \brief checks that answer uses exactly the numbers of input and equals the target. Linear in the length of answer
+///
+answer_check checkAnswer(const input_type targetNumber, input_collection_type input, const std::string &answer);
+
+#endif
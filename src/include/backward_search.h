@@ -0,0 +1,37 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief decides whether a hand can reach a target by working backward from the target
+///
+/// The values reachable from every small sub-multiset of the hand are tabulated up front (see expression_tables.h).
+/// A query asks whether a sub-multiset can produce any value in a range. Small sub-multisets answer from their table;
+/// larger ones are split into a small part, whose values a are known, and the rest, which must then produce a value b
+/// with a op b or b op a in the range. Every operation is monotonic in b over the finite non-zero values of each sign,
+/// so those b form a range again and the rest is queried recursively, until it is small enough to have a table.
+///
+/// Ranges are ranges of doubles in the total order of valueKey, so the requirement on the rest is exact:
+/// b is accepted exactly when the rounded result of the operation lands in the range.
+///
+#ifndef N24_BACKWARD_SEARCH_H
+#define N24_BACKWARD_SEARCH_H
+
+#include <solver.h>
+
+#include <cstdint>
+
+/// \brief work done by the search
+///
+struct backward_stats
+{
+    std::size_t tableLimit = 0; //!< largest sub-multiset with a table
+
+    std::uint64_t queries = 0; //!< ranges required of sub-multisets without a table
+
+    std::uint64_t lookups = 0; //!< ranges looked up in tables
+};
+
+/// \brief true if some expression over the whole input set equals the target
+///
+/// tableLimit is the size of the largest sub-multisets tabulated, at least half the input; 0 picks a size that balances table building against search.
+///
+bool isSolvable(const input_type targetNumber, input_collection_type input, backward_stats *stats = nullptr, std::size_t tableLimit = 0);
+
+#endif
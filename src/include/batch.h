@@ -0,0 +1,69 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief batch mode: solves one hand per line of input
+///
+/// Batch processing is a pipeline of concurrent stages connected by bounded lock-free queues:
+///   1) parse: reads lines and converts them to hands. Files are memory mapped and parsed by several threads
+///   2) solve: a pool of workers computes the solutions of each hand, or only counts them from value tables shared between workers
+///   3) format: renders each result to text, or to JSON, or to a fixed width record for binary output
+///   4) write: reorders the formatted results back into input order and writes them out
+/// A full queue stalls the stage feeding it, and the parser never runs more than a fixed window
+/// of hands ahead of the writer, so memory use stays flat regardless of the size of the input.
+///
+/// When deduplicating, the whole batch is read first. Hands equal as multisets, such as "5 5 5 1" and "1 5 5 5",
+/// are solved once; distinct hands are solved in sorted order so that consecutive hands share sub-multisets,
+/// and the results are fanned back out to every line in input order.
+///
+#ifndef N24_BATCH_H
+#define N24_BATCH_H
+
+#include <multiset_rank.h>
+#include <solver.h>
+
+#include <cstdio>
+#include <istream>
+#include <string>
+
+enum class batch_format
+{
+    text, //!< solution traces followed by a summary line per hand
+    infix, //!< one infix expression per solution followed by a summary line per hand
+    binary, //!< fixed width records in column blocks, see binary_results.h
+    ndjson, //!< one JSON object per line, see ndjson.h
+};
+
+struct batch_options
+{
+    input_type target = 24;
+
+    unsigned threads = 0; //!< number of solver threads, 0 uses the hardware concurrency
+
+    batch_format format = batch_format::text;
+
+    bool countOnly = false; //!< count the distinct solutions of each hand with value tables rather than listing them, see expression_tables.h
+
+    std::size_t cacheCapacity = std::size_t(1) << 24; //!< table values kept for reuse across hands when counting, see table_cache.h
+
+    bool deduplicate = false; //!< solve each distinct hand once, as a sorted multiset, in sorted order. Holds the whole batch in memory
+
+    const multiset_index *hands = nullptr; //!< if every hand is one of these, binary ids are their ranks rather than input positions. Set by runCensus
+};
+
+/// \brief solves every hand read from input, writing the results to output in input order
+///
+void runBatch(std::istream &input, std::FILE *output, const batch_options &options);
+
+/// \brief solves every hand in the file at path, writing the results to output in input order
+///
+/// A regular file is memory mapped and split into line aligned ranges that several parser threads
+/// convert to hands directly from the mapped bytes. Other files, such as pipes, are read as streams.
+///
+void runBatch(const std::string &path, std::FILE *output, const batch_options &options);
+
+/// \brief solves every hand of size integers in [low, high], drawn with repetition, in lexicographic order of the sorted hands
+///
+/// A census generates its hands rather than parsing them. Counted with countOnly, hands sharing sub-multisets share their tables.
+/// Binary ids are the ranks of the hands, see multiset_rank.h, which is also their position in the census.
+///
+void runCensus(const std::size_t size, const int low, const int high, std::FILE *output, const batch_options &options);
+
+#endif
@@ -0,0 +1,53 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief binary columnar layout of batch results
+///
+/// A results file is a header followed by fixed size blocks. Each block holds block_records records
+/// stored column by column, so record i lives in block i / block_records at offset i % block_records
+/// of every column:
+///
+///     std::uint64_t id[block_records];       hand id, see binary_results_header::flags
+///     double        target[block_records];
+///     std::uint64_t count[block_records];    number of solutions
+///     std::uint64_t solution[block_records]; first solution, see encodeSolution. no_solution_code if there is none
+///
+/// The last block is padded with records whose id is binary_results_padding_id.
+/// All values are in the byte order of the machine that wrote the file.
+///
+#ifndef N24_BINARY_RESULTS_H
+#define N24_BINARY_RESULTS_H
+
+#include <cstdint>
+
+static constexpr char binary_results_magic[4] = {'N', '2', '4', 'R'};
+
+static constexpr std::uint32_t binary_results_version = 1;
+
+static constexpr std::uint64_t binary_results_padding_id = ~std::uint64_t(0);
+
+static constexpr std::uint64_t binary_results_unknown_count = ~std::uint64_t(0);
+
+static constexpr std::uint32_t binary_results_id_is_rank = 1; //!< flag: id is the rank of the hand, see binary_results_header::flags
+
+static constexpr unsigned binary_results_rank_size_shift = 8; //!< flags bits 8 to 15: the size of the ranked hands
+
+struct binary_results_header
+{
+    char magic[4];
+
+    std::uint32_t version;
+
+    std::uint32_t block_records; //!< records per block
+
+    /// 0: id is the index of the hand in the batch input.
+    /// binary_results_id_is_rank: id is the rank of the sorted hand among the hands of (flags >> binary_results_rank_size_shift & 0xFF)
+    /// integers in [rank_low, rank_high], see multiset_rank.h. Written by census
+    std::uint32_t flags;
+
+    std::uint64_t record_count; //!< binary_results_unknown_count if the output could not be rewound to record it
+
+    std::int32_t rank_low, rank_high; //!< 0 unless id is a rank
+};
+
+static_assert(sizeof(binary_results_header) == 32, "binary results header must be packed");
+
+#endif
@@ -0,0 +1,142 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief bounded lock-free multi-producer multi-consumer queue
+///
+/// Fixed ring of cells each carrying a sequence number (Vyukov's design): producers and consumers
+/// claim a slot with a single compare-and-swap on their cursor and hand the cell over via its sequence.
+/// push blocks (spins then yields) while the queue is full, which provides backpressure to earlier stages.
+/// Once every producer is done, close() lets consumers drain what remains and then stop.
+///
+#ifndef N24_BOUNDED_QUEUE_H
+#define N24_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+template<class T>
+class bounded_queue final
+{
+    struct cell
+    {
+        std::atomic<std::size_t> sequence;
+
+        T value;
+    };
+
+    static constexpr std::size_t cache_line_size = 64;
+
+    const std::size_t m_Mask;
+
+    std::unique_ptr<cell[]> m_Cells;
+
+    alignas(cache_line_size) std::atomic<std::size_t> m_EnqueuePosition{0};
+
+    alignas(cache_line_size) std::atomic<std::size_t> m_DequeuePosition{0};
+
+    alignas(cache_line_size) std::atomic<bool> m_Closed{false};
+
+    static void backoff(unsigned &attempt)
+    {
+        if (++attempt > 64) std::this_thread::yield();
+    }
+
+public:
+    /// \brief capacity must be a power of two
+    explicit bounded_queue(const std::size_t capacity)
+    : m_Mask(capacity - 1)
+    , m_Cells(new cell[capacity])
+    {
+        if (capacity < 2 || (capacity & (capacity - 1))) throw std::invalid_argument("bounded_queue: capacity must be a power of two");
+
+        for (std::size_t i(0); i < capacity; ++i) m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bounded_queue(const bounded_queue &) = delete;
+    bounded_queue &operator=(const bounded_queue &) = delete;
+
+    /// \brief attempts to enqueue without blocking. value is only moved from on success
+    bool try_push(T &value)
+    {
+        auto position = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto &c = m_Cells[position & m_Mask];
+
+            const auto sequence = c.sequence.load(std::memory_order_acquire);
+
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (!difference)
+            {
+                if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    c.value = std::move(value);
+
+                    c.sequence.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            else if (difference < 0) return false;
+            else position = m_EnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// \brief attempts to dequeue without blocking
+    bool try_pop(T &value)
+    {
+        auto position = m_DequeuePosition.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto &c = m_Cells[position & m_Mask];
+
+            const auto sequence = c.sequence.load(std::memory_order_acquire);
+
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+            if (!difference)
+            {
+                if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(c.value);
+
+                    c.sequence.store(position + m_Mask + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            else if (difference < 0) return false;
+            else position = m_DequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// \brief enqueues, waiting for space if the queue is full
+    void push(T value)
+    {
+        for (unsigned attempt(0); !try_push(value);) backoff(attempt);
+    }
+
+    /// \brief dequeues, waiting for a value. returns false once the queue is closed and drained
+    bool pop(T &value)
+    {
+        for (unsigned attempt(0);; backoff(attempt))
+        {
+            if (try_pop(value)) return true;
+
+            if (m_Closed.load(std::memory_order_acquire)) return try_pop(value);
+        }
+    }
+
+    /// \brief signals that no more values will be pushed
+    void close()
+    {
+        m_Closed.store(true, std::memory_order_release);
+    }
+};
+
+#endif
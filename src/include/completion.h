@@ -0,0 +1,28 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief "which card completes this hand?": the extra values that make a partial hand solvable
+///
+/// The value tables of every sub-multiset of the partial hand are built once and kept in a cache.
+/// Each candidate then only builds the tables of the sub-multisets that contain it, see table_cache.h,
+/// and counts its solutions at the top level without tabulating the whole hand.
+///
+#ifndef N24_COMPLETION_H
+#define N24_COMPLETION_H
+
+#include <expression_tables.h>
+
+#include <vector>
+
+/// \brief one candidate extra value and the number of distinct solutions of the hand it completes
+///
+struct completion
+{
+    input_type value;
+
+    expression_count count;
+};
+
+/// \brief the number of distinct solutions of partial plus each candidate, in the order of candidates
+///
+std::vector<completion> findCompletions(const input_type targetNumber, const input_collection_type &partial, const input_collection_type &candidates);
+
+#endif
@@ -0,0 +1,33 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief target coverage: which integers in a range a hand can reach, with one witness each
+///
+/// The values reachable from the whole hand are tabulated once (see expression_tables.h), and the range is read
+/// off the sorted table, instead of solving the hand once per target.
+///
+#ifndef N24_COVERAGE_H
+#define N24_COVERAGE_H
+
+#include <solver.h>
+
+#include <cstdint>
+#include <vector>
+
+struct coverage
+{
+    std::int64_t low, high;
+
+    input_collection_type input; //!< sorted, witnesses' operands index into this
+
+    std::vector<std::uint64_t> bitmap; //!< bit i of word i / 64 is set if low + i is reachable
+
+    std::vector<solution> witnesses; //!< one per reachable integer, in increasing order
+
+    bool reachable(const std::int64_t target) const;
+};
+
+/// \brief the integers in [low, high] that some expression over the whole input equals, and an expression for each.
+/// Throws if low > high, or if the range holds more than 2^24 integers
+///
+coverage findCoverage(input_collection_type input, const std::int64_t low, const std::int64_t high);
+
+#endif
@@ -0,0 +1,41 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief exact probability that a random deal from a deck is solvable
+///
+/// A deal of k cards is a k-subset of the deck, so many deals share a hand: the hand {1,1,5,5} is dealt
+/// C(4,2) * C(4,2) = 36 ways from a standard deck. Each distinct hand is solved once, with its deal multiplicity as its weight,
+/// rather than solving every deal. Hands are decided by isReachable (see expression_tables.h), from value tables shared between worker threads,
+/// stopping at the first solution. The count of deals is exact; whether a hand is solvable is decided in floating point, as in every other mode.
+///
+#ifndef N24_DEAL_ODDS_H
+#define N24_DEAL_ODDS_H
+
+#include <solver.h>
+
+#include <cstdint>
+
+/// \brief copies of each integer in [low, high]. The default is a standard deck of cards without suits
+///
+struct deck
+{
+    int low = 1, high = 13;
+
+    unsigned copies = 4;
+};
+
+struct deal_odds
+{
+    std::uint64_t hands = 0, solvableHands = 0; //!< distinct hands
+
+    std::uint64_t deals = 0, solvableDeals = 0; //!< deals, counted with multiplicity. deals is C(cards in deck, cards dealt)
+
+    /// \brief solvableDeals / deals
+    double probability() const;
+};
+
+/// \brief the number of deals of cards cards from the deck, and how many of them can make the target
+///
+/// Throws if a count of deals does not fit in 64 bits.
+///
+deal_odds findDealOdds(const input_type targetNumber, const std::size_t cards, const deck &d = {}, unsigned threads = 0);
+
+#endif
@@ -0,0 +1,47 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief renders compact solutions as conventional infix expressions, e.g: "(5-1/5)*5"
+///
+/// Parentheses are only written where precedence and left associativity require them to keep the tree's shape:
+/// a child with lower precedence than its parent, or a right child with equal precedence, e.g. "1+(2+3)" rather than "1+2+3",
+/// which is the tree (1+2)+3. Distinct solutions therefore never render alike.
+/// Negative operands are parenthesized unless they are the whole expression.
+///
+#ifndef N24_EXPRESSION_H
+#define N24_EXPRESSION_H
+
+#include <solver.h>
+
+#include <array>
+#include <string>
+
+/// \brief renders many solutions of one hand. The text of each operand is prepared once up front
+///
+class infix_renderer final
+{
+    struct operand_text
+    {
+        std::array<char, 32> characters;
+
+        std::uint8_t size;
+
+        bool negative;
+    };
+
+    std::array<operand_text, solution::max_operands> m_Operands;
+
+public:
+    explicit infix_renderer(const input_collection_type &input);
+
+    /// \brief appends the infix form of the solution to buffer
+    void write(std::string &buffer, const solution &s) const;
+};
+
+/// \brief appends the infix form of the solution to buffer
+///
+void writeInfix(std::string &buffer, const input_collection_type &input, const solution &s);
+
+/// \brief appends the shortest representation of value that reads back as the same number
+///
+void writeNumber(std::string &buffer, const input_type value);
+
+#endif
@@ -0,0 +1,163 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief counts of distinct expressions per reachable value, for every sub-multiset of a hand
+///
+/// Rather than evaluating every expression, the values reachable from each sub-multiset of the input are tabulated
+/// along with the number of distinct expressions producing each one. A sub-multiset's table is built from the tables of
+/// every ordered split of it into two smaller sub-multisets, combined with each operation.
+///
+/// Two expressions are distinct if they differ in shape, in an operation, or in the value of an operand at some position;
+/// equal input values are interchangeable. Values are compared exactly, as the brute force search does,
+/// except that -0 and +0 are tabulated separately since they behave differently as divisors.
+///
+/// Because every operation is monotonic in either operand over the finite non-zero values of each sign,
+/// the operands b of a table that combine with a given a to produce a given value form a contiguous range of the sorted table,
+/// found by binary search. This lets a table be queried for a single target, and expressions be counted and unranked,
+/// without building the table of the whole hand.
+///
+#ifndef N24_EXPRESSION_TABLES_H
+#define N24_EXPRESSION_TABLES_H
+
+#include <solver.h>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using expression_count = std::uint64_t;
+
+/// \brief the values reachable from one sub-multiset, sorted, and the number of distinct expressions producing each
+///
+struct value_table
+{
+    std::vector<input_type> values; //!< in the total order of valueKey, NaN is never reachable
+
+    std::vector<expression_count> counts;
+
+    std::vector<expression_count> prefix; //!< prefix[i] is the sum of counts[0, i)
+
+    /// \brief index of the entry with exactly this key, or values.size()
+    std::size_t find(const std::uint64_t key) const;
+};
+
+/// \brief maps a value to an integer whose order is the total order of values: -inf < ... < -0 < +0 < ... < +inf
+///
+std::uint64_t valueKey(const input_type value);
+
+/// \brief inverse of valueKey
+///
+input_type valueFromKey(const std::uint64_t key);
+
+class table_cache;
+
+/// \brief restricts the expressions tabulated by expression_tables
+///
+struct expression_filter
+{
+    std::uint8_t operations = 0xF; //!< bit i allows static_cast<Operation>(i)
+
+    bool integers = false; //!< every intermediate value must be an integer
+
+    bool allows(const Operation operation) const { return operations >> static_cast<unsigned>(operation) & 1; }
+
+    /// \brief false if value may not be produced by an operation
+    bool accepts(const input_type value) const { return !integers || (std::isfinite(value) && value == std::floor(value)); }
+};
+
+/// \brief value tables for the sub-multisets of a hand
+///
+/// Sub-multisets are identified by a mixed radix index: digit i is how many copies of the i-th distinct input value are included.
+///
+class expression_tables final
+{
+    input_collection_type m_Input; //!< sorted
+
+    std::vector<input_type> m_Distinct; //!< distinct input values
+
+    std::vector<std::size_t> m_Multiplicity, m_Stride, m_FirstIndex;
+
+    std::vector<std::uint8_t> m_Size; //!< number of operands in each sub-multiset
+
+    std::vector<std::shared_ptr<const value_table>> m_Tables; //!< null where no table was built
+
+    std::size_t m_Full;
+
+    expression_filter m_Filter;
+
+    struct combination;
+
+    template<class Visit> bool forEachCombination(const std::size_t subset, const std::uint64_t key, Visit &&visit) const;
+
+    void buildTable(const std::size_t subset, const unsigned threads);
+
+    void unrank(const std::size_t subset, const std::uint64_t key, expression_count rank, std::uint8_t position, std::vector<std::size_t> &used, solution &s) const;
+
+public:
+    /// \brief builds the tables of every proper sub-multiset of input, and of input itself if includeFull.
+    /// Sub-multisets of more than tableLimit operands are left without a table.
+    /// Tables found in cache are shared rather than built, and tables built are added to it.
+    /// Only expressions passing filter are tabulated and counted.
+    /// The sub-multisets of each size are built on up to threads threads, once every smaller table is done
+    ///
+    explicit expression_tables(input_collection_type input, const bool includeFull = false, const std::size_t tableLimit = solution::max_operands, table_cache *cache = nullptr,
+        const expression_filter filter = {}, const unsigned threads = 1);
+
+    /// \brief the sorted input
+    const input_collection_type &input() const;
+
+    /// \brief index of the whole hand
+    std::size_t full() const;
+
+    /// \brief number of sub-multisets
+    std::size_t size() const;
+
+    /// \brief number of operands in the sub-multiset
+    std::size_t operandCount(const std::size_t subset) const;
+
+    /// \brief true if every operand of part is in subset
+    bool includes(const std::size_t subset, const std::size_t part) const;
+
+    /// \brief table of a sub-multiset, empty for the whole hand unless it was built, and for those above the table limit
+    const value_table &table(const std::size_t subset) const;
+
+    /// \brief number of distinct expressions over the whole hand equal to target
+    expression_count count(const input_type target) const;
+
+    /// \brief number of distinct expressions over the sub-multiset equal to target. Its parts must have tables
+    expression_count count(const std::size_t subset, const input_type target) const;
+
+    /// \brief true if some expression over the whole hand equals target, stopping at the first one found
+    bool reaches(const input_type target) const;
+
+    /// \brief true if some expression over the sub-multiset equals target, stopping at the first one found. Its parts must have tables
+    bool reaches(const std::size_t subset, const input_type target) const;
+
+    /// \brief the expression with the given rank among the count(target) expressions equal to target
+    solution unrank(const input_type target, const expression_count rank) const;
+
+    /// \brief the expression over the sub-multiset with the given rank among the count(subset, target) expressions equal to target.
+    /// Its operands index the whole sorted input
+    solution unrank(const std::size_t subset, const input_type target, expression_count rank) const;
+};
+
+/// \brief true if some expression over the whole input, passing filter, equals the target. This is the test of solvability of every mode
+/// that decides hands without listing their solutions: values are compared in floating point, as the solvers compare them, so a hand
+/// is solvable exactly when findSolutions finds a solution. Tables are shared through cache when one is given
+///
+bool isReachable(const input_type targetNumber, input_collection_type input, table_cache *cache = nullptr, const expression_filter filter = {});
+
+/// \brief draws one of the distinct expressions equal to the target uniformly at random, without enumerating them.
+/// The result holds no solutions if there are none
+///
+solution_set sampleSolution(const input_type targetNumber, input_collection_type input, const std::uint64_t seed, expression_count *count = nullptr);
+
+/// \brief the distinct solutions that use the numbers of any non-empty sub-multiset of the input, each exactly once.
+/// Smaller sub-multisets come first, and each solution's size is the size of its sub-multiset. Every sub-multiset is counted from one set of tables
+///
+solution_set findSubsetSolutions(const input_type targetNumber, input_collection_type input);
+
+/// \brief the number of solutions findSubsetSolutions would list
+///
+expression_count countSubsetSolutions(const input_type targetNumber, input_collection_type input);
+
+#endif
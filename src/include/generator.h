@@ -0,0 +1,58 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief puzzle generator: random hands that satisfy constraints on their solutions
+///
+/// Draw i is generated from the seed and i alone. Worker threads test a round of draws against the constraints, cheapest first,
+/// and the hands accepted are then kept in draw order, so the hands returned depend on the seed but not on the number of threads.
+/// Each draw is first tested for any solution with isReachable, from value tables shared between workers (see table_cache.h),
+/// which stops at the first one found. Solutions are counted first only when --min-solutions is above 1 or --max-solutions is given,
+/// and otherwise only for the hands kept. Hands still in range are then tested for a solution that avoids division, or one whose
+/// intermediate values are all integers, under the corresponding expression_filter.
+///
+#ifndef N24_GENERATOR_H
+#define N24_GENERATOR_H
+
+#include <expression_tables.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct generator_options
+{
+    input_type target = 24;
+
+    std::size_t size = 4; //!< numbers per hand
+
+    int low = 1, high = 13; //!< numbers are integers in [low, high]
+
+    std::size_t count = 1; //!< hands to generate
+
+    expression_count minimumSolutions = 1, maximumSolutions = std::numeric_limits<expression_count>::max(); //!< distinct solutions, inclusive
+
+    bool requiresDivision = false; //!< there is a solution, and every solution divides
+
+    bool requiresFractions = false; //!< there is a solution, and every solution has a non-integer intermediate value
+
+    std::uint64_t seed = 0;
+
+    unsigned threads = 0; //!< 0 uses the hardware concurrency
+
+    std::uint64_t maximumCandidates = 10000000; //!< hands drawn before giving up
+
+    bool rateDifficulty = false; //!< rate each hand kept by enumerating its solutions, and order the hands from hardest to easiest
+};
+
+struct generated_hand
+{
+    input_collection_type input; //!< sorted
+
+    expression_count solutions;
+
+    difficulty rating; //!< only if options.rateDifficulty
+};
+
+/// \brief up to options.count distinct hands satisfying the constraints, sorted, or ranked by difficulty. Fewer are returned if maximumCandidates hands are drawn first
+///
+std::vector<generated_hand> generateHands(const generator_options &options, std::uint64_t *candidates = nullptr);
+
+#endif
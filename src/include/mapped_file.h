@@ -0,0 +1,41 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief read only memory mapped view of a whole file
+///
+/// Only regular files are mapped, and only where POSIX mmap is available. Otherwise the view is empty and mapped() is false:
+/// pipes and FIFOs such as /dev/stdin report no size, and must be read as streams instead.
+///
+#ifndef N24_MAPPED_FILE_H
+#define N24_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+class mapped_file final
+{
+    const char *m_Data = nullptr;
+
+    std::size_t m_Size = 0;
+
+    bool m_Mapped = false;
+
+public:
+    /// \brief throws if the file cannot be opened. An empty regular file maps to an empty view.
+    /// sequential advises the kernel that the file will be read once, front to back
+    explicit mapped_file(const std::string &path, const bool sequential = false);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    const char *begin() const { return m_Data; }
+
+    const char *end() const { return m_Data + m_Size; }
+
+    std::size_t size() const { return m_Size; }
+
+    /// \brief false if the file could not be mapped, and must be read as a stream
+    bool mapped() const { return m_Mapped; }
+};
+
+#endif
@@ -0,0 +1,48 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief dense integer ids for hands: ranks of sorted multisets in the combinatorial number system
+///
+/// The hands of size integers in [low, high], drawn with repetition, are numbered 0, 1, ... in lexicographic order of the sorted hands,
+/// the order runCensus solves them in. A sorted hand v maps to the strictly increasing sequence c_i = (high - v_{size-1-i}) + i,
+/// whose combinatorial number sum C(c_i, i + 1) counts the hands after it. Ranking and unranking read a table of binomial coefficients,
+/// so results can be stored in arrays indexed by rank rather than in maps keyed by hands.
+///
+#ifndef N24_MULTISET_RANK_H
+#define N24_MULTISET_RANK_H
+
+#include <solver.h>
+
+#include <cstdint>
+#include <vector>
+
+class multiset_index final
+{
+    std::size_t m_Size;
+
+    int m_Low, m_High;
+
+    std::vector<std::vector<std::uint64_t>> m_Binomial; //!< m_Binomial[r][n] is C(n, r)
+
+    std::uint64_t m_Count;
+
+public:
+    /// \brief the hands of size integers in [low, high]. Throws if there are 2^64 or more of them
+    ///
+    multiset_index(const std::size_t size, const int low, const int high);
+
+    /// \brief number of hands
+    std::uint64_t count() const;
+
+    std::size_t size() const;
+
+    int low() const;
+
+    int high() const;
+
+    /// \brief rank of the hand, which must be sorted, of the given size, and hold integers in [low, high]. O(size)
+    std::uint64_t rank(const input_collection_type &hand) const;
+
+    /// \brief the sorted hand of the given rank, which must be less than count(). O(size log(high - low))
+    input_collection_type unrank(const std::uint64_t rank) const;
+};
+
+#endif
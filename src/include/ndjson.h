@@ -0,0 +1,71 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief newline delimited JSON output: one object per hand
+///
+///     {"input":[1,5,5,5],"target":24,"count":2,"solutions":["(5-1/5)*5","5*(5-1/5)"]}
+///
+/// Objects are produced by a streaming encoder that appends directly to a caller owned buffer,
+/// so a formatter can reuse one buffer for every hand and no per-solution strings are created.
+///
+#ifndef N24_NDJSON_H
+#define N24_NDJSON_H
+
+#include <solver.h>
+
+#include <cstdint>
+#include <string>
+
+/// \brief minimal streaming JSON encoder. Inserts separators, the caller is responsible for balancing begin and end calls
+///
+class json_writer final
+{
+    std::string &m_Buffer;
+
+    std::uint64_t m_NeedsSeparator = 0; //!< one bit per nesting level
+
+    unsigned m_Depth = 0;
+
+    void separate();
+
+    void open(const char c);
+
+    void close(const char c);
+
+public:
+    explicit json_writer(std::string &buffer);
+
+    void beginObject();
+    void endObject();
+
+    void beginArray();
+    void endArray();
+
+    void key(const char *name);
+
+    void value(const input_type number); //!< non-finite numbers are written as null
+
+    void value(const std::uint64_t number);
+
+    void value(const std::string &text);
+
+    void null();
+
+    /// \brief opens a string value whose content the caller appends to buffer() directly. The content must not require escaping
+    void beginRawString();
+    void endRawString();
+
+    std::string &buffer();
+};
+
+/// \brief appends the JSON object describing one hand, followed by a newline
+///
+/// When next is given the result is a page of solutions and a "next" member holds the cursor of the following page, or null after the last page.
+///
+void writeNdjsonResult(std::string &buffer, const input_collection_type &input, const solution_set &result, const std::string &error, const std::string *next = nullptr);
+
+/// \brief appends the JSON object giving only the number of solutions of one hand, followed by a newline
+///
+///     {"input":[1,5,5,5],"target":24,"count":2}
+///
+void writeNdjsonCount(std::string &buffer, const input_collection_type &input, const input_type target, const std::uint64_t count, const std::string &error);
+
+#endif
@@ -0,0 +1,34 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief finds a single solution by repeatedly combining any two values of the working set
+///
+/// Each level of the search picks an unordered pair of working values and replaces it with one of the results
+/// a+b, a*b, a-b, b-a, a/b, b/a, until one value is left. Equal working values are interchangeable at every level,
+/// not only among the inputs: the working set is kept sorted, and a pair is only tried with the first of each run of equal values,
+/// so {5,5,5} offers one pair (5,5) rather than three. Results that equal an earlier result of the same pair (e.g: 2+2 and 2*2)
+/// lead to the same working set and are skipped as well.
+///
+/// Values are interchangeable when they are identical; -0 and +0 are not, since they behave differently as divisors.
+///
+#ifndef N24_PAIRWISE_SEARCH_H
+#define N24_PAIRWISE_SEARCH_H
+
+#include <solver.h>
+
+#include <cstdint>
+
+/// \brief work done by the search
+///
+struct search_stats
+{
+    std::uint64_t nodes = 0; //!< working sets visited
+
+    std::uint64_t prunedEqualValues = 0; //!< pairs skipped because an equal pair of values was already tried at the same level, one branch each
+
+    std::uint64_t prunedEqualResults = 0; //!< branches skipped because the pair already produced the same result
+};
+
+/// \brief finds one solution for the given input set. The result holds no solutions if there are none
+///
+solution_set findAnySolution(const input_type targetNumber, input_collection_type input, search_stats *stats = nullptr);
+
+#endif
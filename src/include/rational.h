@@ -0,0 +1,44 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief exact fractions of 64 bit integers, for evaluating expressions without rounding
+///
+/// Every operation is checked: a result that does not fit reports failure rather than wrapping around.
+///
+#ifndef N24_RATIONAL_H
+#define N24_RATIONAL_H
+
+#include <solver.h>
+
+#include <cstdint>
+
+/// \brief a fraction in lowest terms, the denominator positive
+///
+struct rational
+{
+    std::int64_t numerator = 0, denominator = 1;
+
+    bool operator==(const rational &other) const { return numerator == other.numerator && denominator == other.denominator; }
+
+    bool operator!=(const rational &other) const { return !(*this == other); }
+};
+
+/// \brief output = a + b, false if it does not fit
+///
+bool checkedAdd(const std::int64_t a, const std::int64_t b, std::int64_t &output);
+
+/// \brief output = a * b, false if it does not fit
+///
+bool checkedMultiply(const std::int64_t a, const std::int64_t b, std::int64_t &output);
+
+/// \brief numerator / denominator in lowest terms, false if denominator is 0 or the result does not fit
+///
+bool makeRational(std::int64_t numerator, std::int64_t denominator, rational &output);
+
+/// \brief output = l operation r, false on division by zero or if the result does not fit
+///
+bool applyOperation(const rational &l, const rational &r, const Operation operation, rational &output);
+
+/// \brief the decimal fraction value is written as, by writeNumber: 0.1 is 1/10. False if value is not finite or does not fit
+///
+bool decimalRational(const input_type value, rational &output);
+
+#endif
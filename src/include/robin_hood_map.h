@@ -0,0 +1,169 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief flat open addressing hash map from 64 bit keys, with Robin Hood probing
+///
+/// Keys, values and probe distances live in three flat arrays allocated once per growth rather than in a node per entry.
+/// A key is placed at the first slot from its home where it is further from home than the occupant, which is displaced
+/// onward in its place, so probe sequences stay short and a lookup stops as soon as it reaches a slot closer to its home than itself.
+/// Probing walks the arrays sequentially, a cache line of keys at a time. Entries are never erased.
+///
+#ifndef N24_ROBIN_HOOD_MAP_H
+#define N24_ROBIN_HOOD_MAP_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template<class Value>
+class robin_hood_map final
+{
+    static constexpr std::size_t MINIMUM_CAPACITY = 16;
+
+    static constexpr std::uint8_t MAXIMUM_DISTANCE = 0xFF; //!< a probe this long grows the map
+
+    std::vector<std::uint64_t> m_Keys;
+
+    std::vector<Value> m_Values;
+
+    std::vector<std::uint8_t> m_Distance; //!< 0 for an empty slot, otherwise 1 + the distance of the slot from its key's home
+
+    std::size_t m_Size = 0;
+
+    unsigned m_Shift; //!< 64 - log2(capacity)
+
+    std::size_t home(const std::uint64_t key) const
+    {
+        // Fibonacci hashing: the top bits of the product depend on every bit of the key
+        return static_cast<std::size_t>((key ^ key >> 29) * 0x9E3779B97F4A7C15ull >> m_Shift);
+    }
+
+    void grow()
+    {
+        auto keys = std::move(m_Keys);
+
+        auto values = std::move(m_Values);
+
+        auto distance = std::move(m_Distance);
+
+        allocate(distance.size() * 2);
+
+        for (std::size_t i(0); i < distance.size(); ++i) if (distance[i]) insert(keys[i], std::move(values[i]));
+    }
+
+    void allocate(const std::size_t capacity)
+    {
+        m_Keys.assign(capacity, 0);
+        m_Values.assign(capacity, Value());
+        m_Distance.assign(capacity, 0);
+
+        m_Size = 0;
+
+        m_Shift = 64;
+
+        for (auto c = capacity; c > 1; c /= 2) --m_Shift;
+    }
+
+    /// \brief places a key known to be absent, returning its slot
+    std::size_t insert(std::uint64_t key, Value value)
+    {
+        if ((m_Size + 1) * 8 > m_Keys.size() * 7) // at most 7/8 full
+        {
+            grow();
+
+            return insert(key, std::move(value));
+        }
+
+        const auto mask = m_Keys.size() - 1;
+
+        std::size_t placed(m_Keys.size());
+
+        std::uint8_t distance(1);
+
+        for (auto i = home(key);; i = (i + 1) & mask, ++distance)
+        {
+            if (distance == MAXIMUM_DISTANCE)
+            {
+                // the key first placed may since have been displaced: remember it, then place the entry in hand in a larger map
+                const auto original = placed < m_Keys.size() ? m_Keys[placed] : key;
+
+                grow();
+
+                insert(key, std::move(value));
+
+                return find(original);
+            }
+
+            if (!m_Distance[i])
+            {
+                m_Keys[i] = key;
+                m_Values[i] = std::move(value);
+                m_Distance[i] = distance;
+
+                ++m_Size;
+
+                return placed < m_Keys.size() ? placed : i;
+            }
+
+            if (m_Distance[i] < distance)
+            {
+                // the occupant is closer to its home: take its slot and carry it onward
+                std::swap(m_Keys[i], key);
+                std::swap(m_Values[i], value);
+                std::swap(m_Distance[i], distance);
+
+                if (placed == m_Keys.size()) placed = i;
+            }
+        }
+    }
+
+    /// \brief slot of a key known to be present
+    std::size_t find(const std::uint64_t key) const
+    {
+        const auto mask = m_Keys.size() - 1;
+
+        auto i = home(key);
+
+        while (m_Keys[i] != key || !m_Distance[i]) i = (i + 1) & mask;
+
+        return i;
+    }
+
+public:
+    explicit robin_hood_map(const std::size_t capacity = MINIMUM_CAPACITY)
+    {
+        std::size_t c(MINIMUM_CAPACITY);
+
+        while (c < capacity) c *= 2;
+
+        allocate(c);
+    }
+
+    /// \brief the value of key, inserted default constructed if absent
+    Value &operator[](const std::uint64_t key)
+    {
+        const auto mask = m_Keys.size() - 1;
+
+        std::uint8_t distance(1);
+
+        // a key further from home than the occupant of a slot would have displaced it: it is absent
+        for (auto i = home(key); m_Distance[i] >= distance; i = (i + 1) & mask, ++distance)
+        {
+            if (m_Keys[i] == key) return m_Values[i];
+        }
+
+        return m_Values[insert(key, Value())];
+    }
+
+    std::size_t size() const
+    {
+        return m_Size;
+    }
+
+    /// \brief calls visit(key, value) for every entry, in no particular order
+    template<class Visit>
+    void forEach(Visit &&visit) const
+    {
+        for (std::size_t i(0); i < m_Keys.size(); ++i) if (m_Distance[i]) visit(m_Keys[i], m_Values[i]);
+    }
+};
+
+#endif
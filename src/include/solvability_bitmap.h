@@ -0,0 +1,100 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief one bit per hand: whether it can make the target, indexed by multiset rank
+///
+/// Bit i is set if the hand of rank i (see multiset_rank.h) is solvable. A directory holds the number of set bits
+/// before every block of 512 bits, so rank (set bits before a position) reads one directory entry and at most 8 words,
+/// and select (position of the k-th set bit) binary searches the directory, then scans one block.
+///
+/// File layout, in the byte order of the machine that wrote it:
+///
+///     solvability_bitmap_header
+///     std::uint64_t words[(bit_count + 63) / 64];          bit i is bit i % 64 of words[i / 64]
+///     std::uint64_t directory[(bit_count + 511) / 512 + 1]; set bits before bit 512 * j, the last entry is one_count
+///
+/// A regular file is mapped rather than read, so loading it costs a few system calls regardless of its size. Other files are read whole.
+///
+#ifndef N24_SOLVABILITY_BITMAP_H
+#define N24_SOLVABILITY_BITMAP_H
+
+#include <mapped_file.h>
+#include <multiset_rank.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr char solvability_bitmap_magic[4] = {'N', '2', '4', 'B'};
+
+static constexpr std::uint32_t solvability_bitmap_version = 1;
+
+struct solvability_bitmap_header
+{
+    char magic[4];
+
+    std::uint32_t version;
+
+    std::uint32_t size; //!< numbers per hand
+
+    std::int32_t low, high; //!< numbers are integers in [low, high]
+
+    std::uint32_t reserved;
+
+    double target;
+
+    std::uint64_t bit_count; //!< number of hands
+
+    std::uint64_t one_count; //!< number of solvable hands
+};
+
+static_assert(sizeof(solvability_bitmap_header) == 48, "solvability bitmap header must be packed");
+
+class solvability_bitmap final
+{
+    solvability_bitmap_header m_Header;
+
+    std::vector<std::uint64_t> m_Storage; //!< words then directory, if built rather than mapped
+
+    std::unique_ptr<mapped_file> m_File;
+
+    const std::uint64_t *m_Words, *m_Directory;
+
+public:
+    static constexpr std::size_t BLOCK_BITS = 512;
+
+    /// \brief the bitmap of the given bits, bit i of words[i / 64] for the hand of rank i
+    solvability_bitmap(const multiset_index &hands, const input_type target, std::vector<std::uint64_t> words);
+
+    /// \brief maps or reads the file at path, throws if it is not a solvability bitmap or its directory does not agree with its bits
+    explicit solvability_bitmap(const std::string &path);
+
+    solvability_bitmap(const solvability_bitmap &) = delete;
+    solvability_bitmap &operator=(const solvability_bitmap &) = delete;
+
+    solvability_bitmap(solvability_bitmap &&) = default;
+
+    const solvability_bitmap_header &header() const;
+
+    /// \brief the hands the bits stand for
+    multiset_index hands() const;
+
+    /// \brief true if the hand of rank i is solvable
+    bool test(const std::uint64_t i) const;
+
+    /// \brief number of solvable hands of rank less than i
+    std::uint64_t rank(const std::uint64_t i) const;
+
+    /// \brief rank of the k-th solvable hand, counting from 0. k must be less than header().one_count.
+    /// The scan never leaves the words: it throws std::out_of_range if they hold fewer set bits than the directory counts
+    std::uint64_t select(const std::uint64_t k) const;
+
+    /// \brief writes the file layout to output
+    void write(std::FILE *output) const;
+};
+
+/// \brief tests every hand of size integers in [low, high] for a solution with isReachable, from value tables shared between threads
+///
+solvability_bitmap buildSolvabilityBitmap(const input_type targetNumber, const std::size_t size, const int low, const int high, unsigned threads = 0, const std::size_t cacheCapacity = std::size_t(1) << 24);
+
+#endif
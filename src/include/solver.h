@@ -0,0 +1,193 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief brute force solver for the 24 game, extended to N game
+///
+/// The solver records each solution in a compact form (see solution) rather than as text,
+/// so that formatting can be deferred, batched or skipped entirely.
+///
+#ifndef N24_SOLVER_H
+#define N24_SOLVER_H
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using input_type = double;
+using input_collection_type = std::vector<input_type>;
+
+enum class Operation : std::uint8_t
+{
+    Addition,
+    Subtraction,
+    Multiplication,
+    Division,
+};
+
+static constexpr std::size_t Operation_Count(4); // <! must be equal to the number of elements in Operation enum
+
+inline std::string Operation_ToString(const Operation o)
+{
+    std::string output;
+
+    switch(o)
+    {
+        case Operation::Addition: output = "+"; break;
+        case Operation::Subtraction: output = "-"; break;
+        case Operation::Multiplication: output = "*"; break;
+        case Operation::Division: output = "/"; break;
+
+        default: throw std::runtime_error([&]()
+        {
+            std::stringstream ss;
+
+            ss << "Operation_ToString: invalid operation: " << static_cast<std::underlying_type<Operation>::type>(o) << std::endl;
+
+            return ss.str();
+        }());
+    }
+
+    return output;
+}
+
+inline char Operation_ToChar(const Operation o)
+{
+    static constexpr char symbols[Operation_Count] = {'+', '-', '*', '/'};
+
+    if (static_cast<std::size_t>(o) >= Operation_Count) return Operation_ToString(o).front(); // throws
+
+    return symbols[static_cast<std::size_t>(o)];
+}
+
+inline input_type Operation_PerformOperation(input_type l, const input_type r, const Operation o)
+{
+    switch(o)
+    {
+        case Operation::Addition: l += r; break;
+        case Operation::Subtraction: l -= r; break;
+        case Operation::Multiplication: l *= r; break;
+        case Operation::Division: l /= r; break;
+
+        default: throw std::runtime_error([&]()
+        {
+            std::stringstream ss;
+
+            ss << "Operation_PerformOperation: invalid operation: " << static_cast<std::underlying_type<Operation>::type>(o) << std::endl;
+
+            return ss.str();
+        }());
+    }
+
+    return l;
+}
+
+/// \brief compact record of a single solution
+///
+/// operands are indices into the sorted input set, in the order they appear in the expression.
+/// Each step combines the values at position and position + 1 of the working set with operation,
+/// replacing the pair with the result. Replaying every step leaves the target as the only value.
+///
+struct solution
+{
+    static constexpr std::size_t max_operands = 16;
+
+    struct step
+    {
+        std::uint8_t position;
+        Operation operation;
+    };
+
+    std::uint8_t size = 0; //!< number of operands
+
+    std::array<std::uint8_t, max_operands> operands;
+
+    std::array<step, max_operands - 1> steps;
+};
+
+/// \brief the result of solving one hand
+///
+struct solution_set
+{
+    input_type target;
+
+    input_collection_type input; //!< sorted, solution::operands index into this
+
+    std::vector<solution> solutions;
+};
+
+/// \brief how hard a hand is to solve, from statistics gathered while its solutions are enumerated
+///
+struct difficulty
+{
+    std::size_t size = 0; //!< numbers in the hand
+
+    std::size_t solutions = 0; //!< distinct solutions
+
+    std::size_t fractionalSolutions = 0; //!< solutions with a non-integer intermediate value
+
+    std::size_t minimumDepth = 0; //!< height of the expression tree of the shallowest solution
+
+    /// \brief higher is harder: 1 / solutions, plus the share of solutions with non-integer intermediate values,
+    /// plus half a point per level the shallowest solution is deeper than a balanced tree. 0 if there is no solution
+    double score() const;
+};
+
+/// \brief finds all solutions for the given input set in compact form, rating the hand while they are found if rating is not null
+///
+solution_set findSolutions(const input_type targetNumber, input_collection_type input, difficulty *rating = nullptr);
+
+/// \brief a page of solutions, and the cursor that resumes the search after it
+///
+struct solution_page
+{
+    solution_set result;
+
+    std::string next; //!< empty once the search is exhausted
+};
+
+/// \brief finds up to pageSize solutions, resuming the search at cursor (empty for the first page)
+///
+/// Pages list solutions in the same order as findSolutions. The cursor is an opaque string that encodes
+/// the position of the next solution in the search (permutation rank, operation configuration and order of operations)
+/// along with a fingerprint of the hand, so only the current page is ever held in memory.
+///
+solution_page findSolutionPage(const input_type targetNumber, input_collection_type input, const std::string &cursor, const std::size_t pageSize);
+
+/// \brief code used when a hand has no solution, or its solution cannot be packed into 64 bits
+///
+static constexpr std::uint64_t no_solution_code = ~std::uint64_t(0);
+
+/// \brief lexicographic rank of operands among the distinct orderings of the sorted input set, as visited by std::next_permutation
+///
+std::uint64_t rankPermutation(const input_collection_type &input, const std::uint8_t *operands, const std::size_t size);
+
+/// \brief inverse of rankPermutation. Equal values are assigned their indices in increasing order
+///
+void unrankPermutation(const input_collection_type &input, std::uint64_t rank, std::uint8_t *operands);
+
+/// \brief packs a solution into 64 bits: the operand count in the top 4 bits, below it the mixed radix number
+/// (permutation rank, step positions, step operations). Returns no_solution_code if the solution does not fit
+///
+std::uint64_t encodeSolution(const input_collection_type &input, const solution &s);
+
+/// \brief inverse of encodeSolution
+///
+solution decodeSolution(const input_collection_type &input, std::uint64_t code);
+
+/// \brief number of distinct expressions among the solutions, in the sense of expression_tables.h:
+/// solutions taking the independent operations of one expression in different orders are the same expression.
+/// The solutions of findSolutions are already distinct
+///
+std::size_t distinctSolutionCount(const solution_set &result);
+
+/// \brief writes the step-by-step trace of a solution: the permuted input set, followed by each operation and the resulting working set
+///
+void formatSolutionTrace(std::ostream &ss, const input_collection_type &input, const solution &s);
+
+/// \brief returns the set of solutions for Shusen's game for the given input set
+///
+std::vector<std::string> calculateSolutions(const input_type targetNumber, input_collection_type &&input);
+
+#endif
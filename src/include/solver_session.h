@@ -0,0 +1,56 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief a hand that is edited one number at a time and re-solved after each edit
+///
+/// The session keeps the value tables of the sub-multisets of its hand in a cache, see table_cache.h.
+/// Tables depend only on the values of their sub-multiset, so after adding, removing or changing one number
+/// only the tables of sub-multisets containing the new number are built; every other table is found in the cache.
+///
+#ifndef N24_SOLVER_SESSION_H
+#define N24_SOLVER_SESSION_H
+
+#include <expression_tables.h>
+#include <table_cache.h>
+
+#include <memory>
+
+class solver_session final
+{
+    input_type m_Target;
+
+    input_collection_type m_Input; //!< in the order numbers were added
+
+    table_cache m_Cache;
+
+    std::unique_ptr<expression_tables> m_Tables; //!< tables of the current hand, built on demand
+
+    const expression_tables &tables();
+
+public:
+    static constexpr std::size_t DEFAULT_CACHE_CAPACITY = std::size_t(1) << 22;
+
+    /// \brief cacheCapacity bounds the number of table values kept across edits
+    ///
+    explicit solver_session(const input_type target, input_collection_type input = {}, const std::size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+    void add(const input_type value);
+
+    /// \brief removes one occurrence of value, throws if the hand does not contain it
+    void remove(const input_type value);
+
+    /// \brief replaces one occurrence of from with to, throws if the hand does not contain from
+    void change(const input_type from, const input_type to);
+
+    void setTarget(const input_type target);
+
+    input_type target() const;
+
+    const input_collection_type &input() const;
+
+    /// \brief number of distinct solutions of the current hand
+    expression_count count();
+
+    /// \brief up to limit distinct solutions of the current hand, in rank order
+    solution_set solutions(const expression_count limit);
+};
+
+#endif
@@ -0,0 +1,76 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief value tables shared across hands
+///
+/// The table of a sub-multiset depends only on its values, so hands such as {1,2,3,4}, {1,2,3,5} and {1,2,3,6}
+/// can share the table of {1,2,3}. The cache is bounded by the total number of values it holds
+/// and evicts the least recently used tables first. It is split into independently locked shards so solver threads rarely contend.
+///
+#ifndef N24_TABLE_CACHE_H
+#define N24_TABLE_CACHE_H
+
+#include <expression_tables.h>
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class table_cache final
+{
+public:
+    using key_type = std::vector<std::uint64_t>; //!< the expression_filter, then valueKey of each value of the sub-multiset, sorted
+
+    using table_pointer = std::shared_ptr<const value_table>;
+
+private:
+    static constexpr std::size_t SHARD_COUNT = 16;
+
+    struct key_hash
+    {
+        std::size_t operator()(const key_type &key) const;
+    };
+
+    struct shard
+    {
+        std::mutex mutex;
+
+        std::list<key_type> recency; //!< most recently used first
+
+        std::unordered_map<key_type, std::pair<table_pointer, std::list<key_type>::iterator>, key_hash> entries;
+
+        std::size_t size = 0; //!< values held
+    };
+
+    std::array<shard, SHARD_COUNT> m_Shards;
+
+    const std::size_t m_ShardCapacity;
+
+    std::atomic<std::uint64_t> m_Hits{0}, m_Misses{0};
+
+    std::atomic<bool> m_Frozen{false};
+
+    shard &shardOf(const key_type &key);
+
+public:
+    /// \brief capacity is the number of table values held across all tables. A capacity of 0 holds nothing
+    ///
+    explicit table_cache(const std::size_t capacity);
+
+    /// \brief the table of the sub-multiset, or null
+    table_pointer find(const key_type &key);
+
+    /// \brief adds the table of the sub-multiset, evicting the least recently used tables of its shard to stay within capacity
+    void insert(const key_type &key, table_pointer table);
+
+    /// \brief stops adding tables: the cache keeps serving the tables it holds
+    void freeze();
+
+    std::uint64_t hits() const;
+
+    std::uint64_t misses() const;
+};
+
+#endif
@@ -1,297 +1,848 @@
 // © 2019 Joseph Cameron - All Rights Reserved
-/// \brief brute force calculator for 24 game, extended to N game
+/// \brief command line front end for the 24 game calculator, extended to N game
 ///
-/// 24 game rules:
-///  given a set of 4 real numbers, the player must create an expression that evaluates to 24
-///  each number MUST be used EXACTLY once.
-///  legal operations are +, -, /, *.
-///  operations can be used any number of times and in any order.
+/// usage:
+///     [options] number...        solve a single hand
+///     --batch <file> [options]   solve one hand per line of file ("-" reads standard input)
+///     --census <size> <low> <high> [options]
+///                                solve every hand of size integers in [low, high], as a batch
+///     --generate <count> <size> <low> <high> [options]
+///                                draw count distinct hands of size integers in [low, high] that satisfy the constraints below, see generator.h
+///     --lookup <file> [number...]
+///                                whether the hand is solvable according to a bitmap written by --census with --bitmap, or without a hand,
+///                                every solvable hand of the bitmap. See solvability_bitmap.h
+///     --deal <cards> [options]   exact probability that a deal of cards cards from the deck is solvable, see deal_odds.h
 ///
-/// The rules have been extended so that:
-///     the target number "24" can be substituted for any other real number.
-///     the user can be given any number of floating point numbers, they are not limited to 4
-///
-/// How the calculator works:
-///   1) a list of all possible permutations of operations for the given set of numbers is generated. 
-///      e.g: given {1, 2, 5}, the list would be: {{+, +, +}, {+, +, -}, {+, +, *}, {+, +, /}, ..., {/, /, /}}.
-///   2) a list of all possible orders of operation is generated ("braces")
-///   3) each possible permutations of operations is applied to every order of operations, applied to each permutation of the input set. 
-///      If the resulting expression is equal to 24, that expression is added to the set of solutions, otherwise it is discarded.
-///   4) each solution is then displayed, along with the number of solutions and the amount of time it took the machine to calculate them.
+/// options:
+///     --target <number>          the number expressions must evaluate to, 24 by default
+///     --threads <count>          number of solver threads used in batch mode, and to build the tables of a single hand's --count
+///     --format <format>          output format:
+///                                    text: solution traces (default)
+///                                    infix: one expression per solution, e.g. (5-1/5)*5
+///                                    ndjson: one JSON object per hand, see ndjson.h
+///                                    binary: batch mode only, see binary_results.h
+///     --output <file>            write batch output to file rather than standard output
+///     --page-size <count>        list at most count solutions of a single hand, followed by the cursor of the next page
+///     --cursor <cursor>          resume listing solutions where the previous page ended
+///     --sample                   show one distinct solution drawn uniformly at random
+///     --seed <number>            seed for --sample, so that draws can be reproduced
+///     --any                      stop at the first solution found by the pairwise search, see pairwise_search.h, and show its statistics
+///     --solvable                 only decide whether the hand has a solution, searching backward from the target, see backward_search.h
+///     --session                  edit the hand with commands read from standard input, re-solving after each, see solver_session.h:
+///                                    add <number>, remove <number>, change <number> <number>, target <number>, list <count>
+///     --complete <low> <high>    list which extra integer in [low, high] completes the hand, and its number of distinct solutions, see completion.h
+///     --cover <low> <high>       list which integers in [low, high] the hand can reach, with a witness each, and their bitmap, see coverage.h
+///     --check <answer>           check an infix answer for the hand, e.g. "(5-1/5)*5", evaluated exactly, see answer_check.h.
+///                                "-" checks one answer per line of standard input
+///     --rank <low> <high>        print the rank of the hand among the hands of its size with integers in [low, high], see multiset_rank.h
+///     --subsets                  also accept solutions that use only some of the numbers, each at most once
+///     --count                    count the distinct solutions without listing them, see expression_tables.h.
+///                                In batch mode tables are shared across hands, see table_cache.h
+///     --dedupe                   solve hands that are equal as multisets once per batch, see batch.h
+///     --bitmap <file>            with --census, write one bit per hand, whether it is solvable, to file rather than solving in batch
+///     --cache <values>           number of table values kept for reuse across hands when counting a batch
+///     --min-solutions <count>    generate hands with at least count distinct solutions, 1 by default
+///     --max-solutions <count>    generate hands with at most count distinct solutions
+///     --requires-division        generate hands whose every solution divides
+///     --requires-fractions       generate hands whose every solution passes through a non-integer value
+///     --deck <low> <high> <copies>
+///                                the deck dealt from, copies of each integer in [low, high]. 4 copies of 1 to 13 by default
+///     --difficulty               rate the hand from its solutions as they are found, see solver.h. Generated hands are ranked hardest first
 ///
+#include <answer_check.h>
+#include <backward_search.h>
+#include <batch.h>
+#include <completion.h>
+#include <deal_odds.h>
+#include <coverage.h>
+#include <expression.h>
+#include <expression_tables.h>
+#include <generator.h>
+#include <multiset_rank.h>
+#include <ndjson.h>
+#include <pairwise_search.h>
+#include <solvability_bitmap.h>
+#include <solver_session.h>
+#include <solver.h>
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
-using input_type = double;
-using input_collection_type = std::vector<input_type>;
-
-/// \brief returns the set of solutions for Shusen's game for the given input set
-///
-std::vector<std::string> calculateSolutions(const input_type targetNumber, input_collection_type &&input)
+namespace
 {
-    //
-    // 0. Handle trivial cases
-    //
-    if (!input.size()) return {};
-    else if (input.size() == 1)
-    {
-        if (const auto front = input.front(); front == targetNumber) return {std::string("{") + std::to_string(front) + "}\n"}; 
-        else return {};
-    }
+    static constexpr std::size_t DEFAULT_PAGE_SIZE = 100; //!< used when only a cursor is given
 
-    enum class Operation : decltype(input.size())
+    /// \brief command line options. Parameters that are not options are the numbers of the hand
+    ///
+    struct options
     {
-        Addition,
-        Subtraction,
-        Multiplication,
-        Division,
+        input_type target = 24;
+
+        std::string batchPath;
+
+        std::size_t censusSize = 0;
+
+        int censusLow = 0, censusHigh = 0;
+
+        std::size_t cacheCapacity = batch_options().cacheCapacity;
+
+        bool deduplicate = false;
+
+        unsigned threads = 0;
+
+        batch_format format = batch_format::text;
+
+        std::string outputPath;
+
+        std::size_t pageSize = 0;
+
+        std::string cursor;
+
+        bool sample = false;
+
+        bool count = false;
+
+        bool any = false;
+
+        bool solvable = false;
+
+        bool cover = false;
+
+        std::int64_t coverLow = 0, coverHigh = 0;
+
+        bool subsets = false;
+
+        bool session = false;
+
+        bool complete = false;
+
+        int completeLow = 0, completeHigh = 0;
+
+        bool rateDifficulty = false;
+
+        std::string answer;
+
+        bool rank = false;
+
+        std::string bitmapPath, lookupPath;
+
+        int rankLow = 0, rankHigh = 0;
+
+        std::size_t dealCards = 0;
+
+        deck dealDeck;
+
+        bool generate = false;
+
+        generator_options generator;
+
+        std::uint64_t seed = std::random_device()();
+
+        std::vector<std::string> numbers;
     };
-    
-    static constexpr decltype(input.size()) Operation_Count(4); // <! must be equal to the number of elements in Operation enum
 
-    static constexpr auto Operation_ToString = [](const Operation o)
+    options parseOptions(const std::vector<std::string> &parameters)
     {
-        std::string output;
+        options output;
 
-        switch(o)
+        for (decltype(parameters.size()) i(0); i < parameters.size(); ++i)
         {
-            case Operation::Addition: output = "+"; break; 
-            case Operation::Subtraction: output = "-"; break;
-            case Operation::Multiplication: output = "*"; break;
-            case Operation::Division: output = "/"; break;
+            const auto &param = parameters[i];
 
-            default: throw std::runtime_error([&]()
+            if (param.size() < 2 || param[0] != '-' || param[1] != '-')
             {
-                std::stringstream ss;
-                
-                ss << "Operation_ToString: invalid operation: " << static_cast<std::underlying_type<Operation>::type>(o) << std::endl;
+                output.numbers.push_back(param);
 
-                return ss.str();
-            }());
+                continue;
+            }
+
+            const auto value = [&]()
+            {
+                if (++i >= parameters.size()) throw std::runtime_error(std::string("option ") + param + " requires a value");
+
+                return parameters[i];
+            };
+
+            if (param == "--target") output.target = std::stod(value());
+            else if (param == "--batch") output.batchPath = value();
+            else if (param == "--census")
+            {
+                output.censusSize = static_cast<std::size_t>(std::stoul(value()));
+                output.censusLow = std::stoi(value());
+                output.censusHigh = std::stoi(value());
+            }
+            else if (param == "--cache") output.cacheCapacity = static_cast<std::size_t>(std::stoull(value()));
+            else if (param == "--dedupe") output.deduplicate = true;
+            else if (param == "--threads") output.threads = static_cast<unsigned>(std::stoul(value()));
+            else if (param == "--format")
+            {
+                const auto format = value();
+
+                if (format == "text") output.format = batch_format::text;
+                else if (format == "infix") output.format = batch_format::infix;
+                else if (format == "binary") output.format = batch_format::binary;
+                else if (format == "ndjson") output.format = batch_format::ndjson;
+                else throw std::runtime_error(std::string("unknown format: ") + format);
+            }
+            else if (param == "--output") output.outputPath = value();
+            else if (param == "--page-size") output.pageSize = static_cast<std::size_t>(std::stoul(value()));
+            else if (param == "--cursor") output.cursor = value();
+            else if (param == "--sample") output.sample = true;
+            else if (param == "--seed") output.seed = std::stoull(value());
+            else if (param == "--count") output.count = true;
+            else if (param == "--any") output.any = true;
+            else if (param == "--solvable") output.solvable = true;
+            else if (param == "--session") output.session = true;
+            else if (param == "--subsets") output.subsets = true;
+            else if (param == "--cover")
+            {
+                output.cover = true;
+                output.coverLow = std::stoll(value());
+                output.coverHigh = std::stoll(value());
+            }
+            else if (param == "--complete")
+            {
+                output.complete = true;
+                output.completeLow = std::stoi(value());
+                output.completeHigh = std::stoi(value());
+            }
+            else if (param == "--generate")
+            {
+                output.generate = true;
+                output.generator.count = static_cast<std::size_t>(std::stoul(value()));
+                output.generator.size = static_cast<std::size_t>(std::stoul(value()));
+                output.generator.low = std::stoi(value());
+                output.generator.high = std::stoi(value());
+            }
+            else if (param == "--min-solutions") output.generator.minimumSolutions = std::stoull(value());
+            else if (param == "--max-solutions") output.generator.maximumSolutions = std::stoull(value());
+            else if (param == "--requires-division") output.generator.requiresDivision = true;
+            else if (param == "--requires-fractions") output.generator.requiresFractions = true;
+            else if (param == "--rank")
+            {
+                output.rank = true;
+                output.rankLow = std::stoi(value());
+                output.rankHigh = std::stoi(value());
+            }
+            else if (param == "--bitmap") output.bitmapPath = value();
+            else if (param == "--lookup") output.lookupPath = value();
+            else if (param == "--check") output.answer = value();
+            else if (param == "--deal") output.dealCards = static_cast<std::size_t>(std::stoul(value()));
+            else if (param == "--deck")
+            {
+                output.dealDeck.low = std::stoi(value());
+                output.dealDeck.high = std::stoi(value());
+                output.dealDeck.copies = static_cast<unsigned>(std::stoul(value()));
+            }
+            else if (param == "--difficulty") output.rateDifficulty = output.generator.rateDifficulty = true;
+            else throw std::runtime_error(std::string("unknown option: ") + param);
         }
 
         return output;
-    };
+    }
+}
 
-    static constexpr auto Operation_PerformOperation = [](input_type l, const input_type r, const Operation o)     
+/// Program entry, input sanitization, output display
+///
+/// Shusen's set: 1, 5, 5, 5
+/// Yuhao's set:  1, 2, 5, 6
+///
+int main(int argc, char **argv)
+{
+    try
     {
-        switch(o)
+        const auto opts = parseOptions(std::vector<std::string>(argv + 1, argv + argc));
+
+        if (opts.censusSize && !opts.bitmapPath.empty())
         {
-            case Operation::Addition: l += r; break;
-            case Operation::Subtraction: l -= r; break;
-            case Operation::Multiplication: l *= r; break;
-            case Operation::Division: l /= r; break;
+            const auto start_time(std::chrono::steady_clock::now());
 
-            default: throw std::runtime_error([&]()
-            {
-                std::stringstream ss;
-                
-                ss << "Operation_PerformOperation: invalid operation: " << static_cast<std::underlying_type<Operation>::type>(o) << std::endl;
+            const auto bitmap = buildSolvabilityBitmap(opts.target, opts.censusSize, opts.censusLow, opts.censusHigh, opts.threads, opts.cacheCapacity);
 
-                return ss.str();
-            }());
+            std::FILE *output = std::fopen(opts.bitmapPath.c_str(), "wb");
+
+            if (!output) throw std::runtime_error(std::string("could not open output file: ") + opts.bitmapPath);
+
+            bitmap.write(output);
+
+            std::fclose(output);
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            std::cout << bitmap.header().one_count << " of " << bitmap.header().bit_count << " hands are solvable, time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
         }
-        
-        return l;
-    };
-    
-    const auto NUMBER_OF_OPERATIONS_IN_EXPRESSION(input.size() - 1);
 
-    //
-    // 1. Generate list of all possible operation configurations for an input of the given length
-    //
-    const std::vector<std::vector<Operation>> operation_permutations = [&NUMBER_OF_OPERATIONS_IN_EXPRESSION]()
-    {
-        std::remove_const<decltype(operation_permutations)>::type buffer;
+        if (!opts.batchPath.empty() || opts.censusSize)
+        {
+            batch_options batch;
+
+            batch.target = opts.target;
+            batch.threads = opts.threads;
+            batch.format = opts.format;
+            batch.countOnly = opts.count;
+            batch.cacheCapacity = opts.cacheCapacity;
+            batch.deduplicate = opts.deduplicate;
+
+            std::FILE *output = stdout;
+
+            if (!opts.outputPath.empty() && !(output = std::fopen(opts.outputPath.c_str(), "wb"))) throw std::runtime_error(std::string("could not open output file: ") + opts.outputPath);
 
-        for (decltype(input.size()) i(0), s(static_cast<decltype(s)>(std::pow(Operation_Count, NUMBER_OF_OPERATIONS_IN_EXPRESSION))); i < s; ++i)
+            if (opts.censusSize) runCensus(opts.censusSize, opts.censusLow, opts.censusHigh, output, batch);
+            else if (opts.batchPath == "-") runBatch(std::cin, output, batch);
+            else runBatch(opts.batchPath, output, batch);
+
+            if (output != stdout) std::fclose(output);
+
+            return EXIT_SUCCESS;
+        }
+
+        if (opts.dealCards)
         {
-            auto decimalValueBuffer = i;
+            const auto start_time(std::chrono::steady_clock::now());
 
-            decltype(buffer)::value_type current_operations_permutation(NUMBER_OF_OPERATIONS_IN_EXPRESSION);
+            const auto odds = findDealOdds(opts.target, opts.dealCards, opts.dealDeck, opts.threads);
 
-            for (decltype(i) j(0); decimalValueBuffer != 0; ++j)
-            {
-                const decltype(i) digit = decimalValueBuffer % Operation_Count;
+            const auto end_time(std::chrono::steady_clock::now());
 
-                if (digit < 0 || digit > Operation_Count - 1) throw std::runtime_error([digit, i]()
-                {
-                    std::stringstream ss;
+            const auto divisor = std::max<std::uint64_t>(1, std::gcd(odds.solvableDeals, odds.deals));
+
+            std::cout << odds.solvableDeals << " of " << odds.deals << " deals are solvable, " << odds.solvableDeals / divisor << "/" << odds.deals / divisor
+                << " = " << std::setprecision(std::numeric_limits<double>::max_digits10) << odds.probability() << "\n"
+                << odds.solvableHands << " of " << odds.hands << " distinct hands are solvable, time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
+        }
 
-                    ss << "error: failed to convert decimal digit: " << i << " to base " << Operation_Count << " digit: " << digit;
+        if (opts.generate)
+        {
+            auto generator = opts.generator;
+
+            generator.target = opts.target;
+            generator.seed = opts.seed;
+            generator.threads = opts.threads;
+
+            const auto start_time(std::chrono::steady_clock::now());
+
+            std::uint64_t candidates(0);
+
+            const auto hands = generateHands(generator, &candidates);
 
-                    return ss.str();
-                }());
+            const auto end_time(std::chrono::steady_clock::now());
 
-                current_operations_permutation[j] = static_cast<Operation>(digit);
+            std::string buffer;
+
+            for (const auto &hand : hands)
+            {
+                if (opts.format == batch_format::ndjson && opts.rateDifficulty)
+                {
+                    json_writer json(buffer);
+
+                    json.beginObject();
+                    json.key("input");
+                    json.beginArray();
+                    for (const auto value : hand.input) json.value(value);
+                    json.endArray();
+                    json.key("target");
+                    json.value(opts.target);
+                    json.key("count");
+                    json.value(hand.solutions);
+                    json.key("fractional");
+                    json.value(static_cast<std::uint64_t>(hand.rating.fractionalSolutions));
+                    json.key("depth");
+                    json.value(static_cast<std::uint64_t>(hand.rating.minimumDepth));
+                    json.key("difficulty");
+                    json.value(hand.rating.score());
+                    json.endObject();
+
+                    buffer += '\n';
+                }
+                else if (opts.format == batch_format::ndjson) writeNdjsonCount(buffer, hand.input, opts.target, hand.solutions, {});
+                else
+                {
+                    // one hand per line, as read by --batch
+                    for (decltype(hand.input.size()) i(0); i < hand.input.size(); ++i) buffer += (i ? " " : "") + std::to_string(static_cast<int>(hand.input[i]));
 
-                decimalValueBuffer /= Operation_Count;                
+                    buffer += '\n';
+                }
             }
 
-            buffer.push_back(current_operations_permutation);
+            std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+            std::cerr << hands.size() << " of " << generator.count << " hands from " << candidates << " candidates with seed " << opts.seed << ", time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
         }
 
-        return buffer;
-    }();
-    
-    //
-    // 2. Generate a list of all possible order of operations given the length of this input
-    //
-    const std::vector<std::vector<int>> order_of_operation_permutations = [&NUMBER_OF_OPERATIONS_IN_EXPRESSION]() //TODO: why int
-    {
-        std::remove_const<decltype(order_of_operation_permutations)>::type buffer;
+        const auto &parameters = opts.numbers;
+
+        const input_collection_type input = [&parameters]()
+        {
+            input_collection_type input;
+
+            input.reserve(parameters.size());
 
-        decltype(order_of_operation_permutations)::value_type current_order_of_operations;
+            for (const auto &param : parameters) 
+            {
+                try
+                {
+                    input.push_back(std::stod(param));
+                }
+                catch (const std::invalid_argument &)
+                {
+                    std::cerr << "input contains invalid parameter: \"" << param << "\". All inputs must be integer or floating point numbers" << std::endl;
 
-        current_order_of_operations.reserve(NUMBER_OF_OPERATIONS_IN_EXPRESSION);
+                    return decltype(input)();
+                }
+            }
+
+            return input;
+        }();
+
+        if (opts.format == batch_format::binary) throw std::runtime_error("binary output is only available in batch mode");
 
-        for (std::remove_const<decltype(NUMBER_OF_OPERATIONS_IN_EXPRESSION)>::type i = 0; i < NUMBER_OF_OPERATIONS_IN_EXPRESSION; ++i) 
+        if (!opts.lookupPath.empty())
         {
-            current_order_of_operations.push_back(i);
+            const auto start_time(std::chrono::steady_clock::now());
+
+            const solvability_bitmap bitmap(opts.lookupPath);
+
+            const auto hands = bitmap.hands();
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            const auto loadTime = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+            if (!input.empty())
+            {
+                auto sorted = input;
+
+                std::sort(sorted.begin(), sorted.end());
+
+                const auto rank = hands.rank(sorted);
+
+                std::cout << (bitmap.test(rank) ? "Solvable" : "No solution") << ", hand " << rank << ", " << bitmap.rank(rank) << " solvable hands before it, loaded in (microseconds): " << loadTime << std::endl;
+
+                return EXIT_SUCCESS;
+            }
+
+            std::string buffer;
+
+            for (std::uint64_t k(0); k < bitmap.header().one_count; ++k)
+            {
+                const auto hand = hands.unrank(bitmap.select(k));
+
+                for (decltype(hand.size()) i(0); i < hand.size(); ++i) buffer += (i ? " " : "") + std::to_string(static_cast<int>(hand[i]));
+
+                buffer += '\n';
+            }
+
+            std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+            std::cerr << bitmap.header().one_count << " of " << bitmap.header().bit_count << " hands are solvable for target " << bitmap.header().target
+                << ", loaded in (microseconds): " << loadTime << std::endl;
+
+            return EXIT_SUCCESS;
         }
 
-        std::sort(current_order_of_operations.begin(), current_order_of_operations.end()); //std::next_permutation requires sorted data
+        if (opts.rank)
+        {
+            const multiset_index hands(input.size(), opts.rankLow, opts.rankHigh);
+
+            auto sorted = input;
+
+            std::sort(sorted.begin(), sorted.end());
 
-        do
+            const auto rank = hands.rank(sorted);
+
+            std::cout << "rank " << rank << " of " << hands.count() << " hands" << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        if (!opts.answer.empty())
         {
-            buffer.push_back(current_order_of_operations);
+            const auto start_time(std::chrono::steady_clock::now());
+
+            std::size_t answers(0), correct(0);
+
+            const auto check = [&](const std::string &answer)
+            {
+                const auto result = checkAnswer(opts.target, input, answer);
+
+                ++answers;
+
+                if (result.verdict == answer_verdict::correct) ++correct;
+
+                std::cout << answer << ": " << result.message() << "\n";
+            };
+
+            if (opts.answer != "-") check(opts.answer);
+            else for (std::string line; std::getline(std::cin, line);) check(line);
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            std::cout << correct << " of " << answers << " answer" << (answers != 1 ? "s" : "") << " correct, time taken (microseconds): "
+                << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
         }
-        while(std::next_permutation(current_order_of_operations.begin(), current_order_of_operations.end()));
 
-        return buffer;
-    }();
+        if (opts.solvable)
+        {
+            const auto start_time(std::chrono::steady_clock::now());
+
+            backward_stats stats;
 
-    //
-    // 3. Apply all operation configurations to all orders of operations to all permutations of the input set. 
-    // Record those expressions which equal targetNumber to the solutions array.
-    //
-    std::vector<std::string> solutions;
+            const auto solvable = isSolvable(opts.target, input, &stats);
 
-    std::sort(input.begin(), input.end()); //std::next_permutation requires sorted data
+            const auto end_time(std::chrono::steady_clock::now());
 
-    do
-    {
-        //const auto s(input.size());
-        
-        for (const auto &operations : operation_permutations)
+            std::cout << (solvable ? "Solvable" : "No solution") << ", time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            std::cout << "tables up to " << stats.tableLimit << " numbers, " << stats.queries << " backward queries, " << stats.lookups << " table lookups" << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        if (opts.session)
         {
-            for (auto &current_order_of_operations : order_of_operation_permutations)
+            solver_session session(opts.target, input);
+
+            const auto report = [&session](const std::string &listing)
             {
-                auto input_copy = input;
+                const auto start_time(std::chrono::steady_clock::now());
 
-                decltype(input.size()) i(0); 
-                
-                input_type buffer;
+                const auto count = session.count();
 
-                std::stringstream ss;
+                const auto end_time(std::chrono::steady_clock::now());
+
+                std::cout << listing << "{";
+
+                for (decltype(session.input().size()) i(0); i < session.input().size(); ++i) std::cout << (i ? ", " : "") << session.input()[i];
+
+                std::cout << "}: " << (!count ? std::string("No solution") : std::to_string(count) + " solution" + (count > 1 ? "s" : ""))
+                    << ", time taken (microseconds): " << std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() << std::endl;
+            };
+
+            if (!input.empty()) report({});
+
+            for (std::string line; std::getline(std::cin, line);)
+            {
+                std::stringstream ss(line);
 
-                std::make_signed<decltype(input_copy.size())>::type deletionOffset = 0;
-                
-                do
+                std::string command;
+
+                if (!(ss >> command)) continue;
+
+                try
                 {
-                    auto order = current_order_of_operations[i] - deletionOffset;
-                    
-                    if (order < 0) order = 0;
-                    else if (static_cast<size_t>(order) >= input_copy.size() - 1) order = input_copy.size() - 1;
-                    
-                    ss << input_copy[order] << Operation_ToString(operations[i]) << input_copy[order + 1] << ": ";
+                    std::string listing;
 
-                    buffer = Operation_PerformOperation(input_copy[order], input_copy[order + 1], operations[i]);
+                    const auto number = [&ss, &command]()
+                    {
+                        input_type value;
 
-                    input_copy[order] = buffer;
+                        if (!(ss >> value)) throw std::runtime_error(command + " requires a number");
 
-                    input_copy.erase(input_copy.begin() + order + 1);
+                        return value;
+                    };
 
-                    ss << "{";
-                    
-                    for (decltype(input_copy.size()) i = 0; i < input_copy.size(); ++i)
+                    if (command == "add") session.add(number());
+                    else if (command == "remove") session.remove(number());
+                    else if (command == "change")
                     {
-                        ss << input_copy[i]; 
-                        
-                        if (i != input_copy.size() - 1) ss << ", "; 
+                        const auto from = number();
+
+                        session.change(from, number());
                     }
+                    else if (command == "target") session.setTarget(number());
+                    else if (command == "list")
+                    {
+                        const auto limit = number();
 
-                    ss << "}\n";
+                        // the conversion is only defined for whole numbers that fit, and NaN fails every comparison
+                        if (!(limit >= 0 && limit < std::ldexp(input_type(1), std::numeric_limits<expression_count>::digits) && limit == std::floor(limit)))
+                        {
+                            throw std::runtime_error(command + " requires a whole number of solutions");
+                        }
 
-                    deletionOffset++;
-                    
-                    ++i;
-                }
-                while(i < operations.size());
+                        const auto solutions = session.solutions(static_cast<expression_count>(limit));
+
+                        const infix_renderer renderer(solutions.input);
+
+                        for (const auto &s : solutions.solutions)
+                        {
+                            renderer.write(listing, s);
 
-                if (input_copy.front() == targetNumber)
+                            listing += '\n';
+                        }
+                    }
+                    else throw std::runtime_error(std::string("unknown command: ") + command);
+
+                    report(listing);
+                }
+                catch (const std::exception &e)
                 {
-                    std::stringstream ssOutput;
+                    std::cerr << "error: " << e.what() << std::endl;
+                }
+            }
+
+            return EXIT_SUCCESS;
+        }
+
+        if (opts.cover)
+        {
+            const auto start_time(std::chrono::steady_clock::now());
+
+            const auto result = findCoverage(input, opts.coverLow, opts.coverHigh);
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            const infix_renderer renderer(result.input);
+
+            const auto bitmap = [&result]()
+            {
+                std::stringstream ss;
+
+                ss << std::hex << std::setfill('0');
+
+                for (const auto word : result.bitmap) ss << std::setw(16) << word;
+
+                return ss.str();
+            }();
 
-                    ssOutput << "{";
+            std::string buffer;
 
-                    const decltype(input.size()) s = input.size();
-                    
-                    for (decltype(input.size()) i = 0; i < s; ++i)
+            if (opts.format == batch_format::ndjson)
+            {
+                json_writer json(buffer);
+
+                json.beginObject();
+                json.key("input");
+                json.beginArray();
+                for (const auto value : input) json.value(value);
+                json.endArray();
+                json.key("low");
+                json.value(static_cast<input_type>(result.low));
+                json.key("high");
+                json.value(static_cast<input_type>(result.high));
+                json.key("bitmap");
+                json.value(bitmap);
+                json.key("witnesses");
+                json.beginObject();
+                auto witness = result.witnesses.begin();
+                // stops at high rather than past it, which may be the largest integer
+                for (auto target = result.low;; ++target)
+                {
+                    if (result.reachable(target))
                     {
-                        ssOutput << input[i];
+                        const auto name = std::to_string(target);
 
-                        if (i != s - 1) ssOutput << ", "; 
+                        json.key(name.c_str());
+                        json.beginRawString();
+                        renderer.write(json.buffer(), *witness++);
+                        json.endRawString();
                     }
-                    
-                    ssOutput << "}\n" << ss.str();
 
-                    solutions.push_back(ssOutput.str());
+                    if (target == result.high) break;
                 }
+                json.endObject();
+                json.endObject();
+
+                buffer += '\n';
+
+                std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+                return EXIT_SUCCESS;
             }
-        }
-    } 
-    while(std::next_permutation(input.begin(), input.end()));
 
-    return solutions;
-}
+            auto witness = result.witnesses.begin();
 
-/// Program entry, input sanitization, output display
-///
-/// Shusen's set: 1, 5, 5, 5
-/// Yuhao's set:  1, 2, 5, 6
-///
-int main(int argc, char **argv)
-{
-    try
-    {
-        const std::vector<std::string> parameters(argv + 1, argv + argc);
+            for (auto target = result.low;; ++target)
+            {
+                buffer = std::to_string(target) + ": ";
 
-        const auto start_time(std::chrono::steady_clock::now());
-        
-        auto solutions = calculateSolutions(24, [&parameters]()
+                if (result.reachable(target)) renderer.write(buffer, *witness++);
+                else buffer += "unreachable";
+
+                std::cout << buffer << "\n";
+
+                if (target == result.high) break;
+            }
+
+            std::cout << "bitmap: " << bitmap << "\n" << result.witnesses.size() << " of " << result.high - result.low + 1 << " targets reachable, time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        if (opts.complete)
         {
-            input_collection_type input;
+            const auto start_time(std::chrono::steady_clock::now());
 
-            input.reserve(parameters.size());
+            input_collection_type candidates;
 
-            for (const auto &param : parameters) 
+            for (auto value = opts.completeLow; value <= opts.completeHigh; ++value) candidates.push_back(value);
+
+            const auto completions = findCompletions(opts.target, input, candidates);
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            if (opts.format == batch_format::ndjson)
             {
-                try
+                std::string buffer;
+
+                json_writer json(buffer);
+
+                json.beginObject();
+                json.key("input");
+                json.beginArray();
+                for (const auto value : input) json.value(value);
+                json.endArray();
+                json.key("target");
+                json.value(opts.target);
+                json.key("completions");
+                json.beginArray();
+                for (const auto &c : completions)
                 {
-                    input.push_back(std::stod(param));
+                    json.beginObject();
+                    json.key("value");
+                    json.value(c.value);
+                    json.key("count");
+                    json.value(c.count);
+                    json.endObject();
                 }
-                catch (const std::invalid_argument &)
-                {
-                    std::cerr << "input contains invalid parameter: \"" << param << "\". All inputs must be integer or floating point numbers" << std::endl;
+                json.endArray();
+                json.endObject();
 
-                    return decltype(input)();
-                }
+                buffer += '\n';
+
+                std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+                return EXIT_SUCCESS;
             }
 
-            return input;
-        }()); 
+            std::size_t completing(0);
+
+            for (const auto &c : completions)
+            {
+                std::cout << c.value << ": " << (!c.count ? std::string("No solution") : std::to_string(c.count) + " solution" + (c.count > 1 ? "s" : "")) << "\n";
+
+                if (c.count) ++completing;
+            }
+
+            std::cout << completing << " of " << completions.size() << " values complete the hand, time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        if (opts.count)
+        {
+            const auto start_time(std::chrono::steady_clock::now());
+
+            const unsigned threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+
+            const auto count = opts.subsets ? countSubsetSolutions(opts.target, input)
+                : expression_tables(input, false, solution::max_operands, nullptr, {}, threads).count(opts.target);
+
+            const auto end_time(std::chrono::steady_clock::now());
+
+            if (opts.format == batch_format::ndjson)
+            {
+                std::string buffer;
+
+                writeNdjsonCount(buffer, input, opts.target, count, {});
+
+                std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+            }
+            else std::cout << count << " distinct solution" << (count != 1 ? "s" : "") << ", time taken (milliseconds): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        const bool paged = opts.pageSize || !opts.cursor.empty();
+
+        std::string next;
+
+        const auto start_time(std::chrono::steady_clock::now());
+
+        expression_count distinct(0);
+
+        search_stats stats;
+
+        difficulty rating;
+
+        const auto result = opts.subsets ? findSubsetSolutions(opts.target, input)
+        : opts.any ? findAnySolution(opts.target, input, &stats)
+        : opts.sample ? sampleSolution(opts.target, input, opts.seed, &distinct)
+        : paged ? [&opts, &input, &next]()
+        {
+            auto page = findSolutionPage(opts.target, input, opts.cursor, opts.pageSize ? opts.pageSize : DEFAULT_PAGE_SIZE);
+
+            next = std::move(page.next);
+
+            return std::move(page.result);
+        }()
+        : findSolutions(opts.target, input, opts.rateDifficulty ? &rating : nullptr);
+
+        if (opts.format == batch_format::ndjson)
+        {
+            std::string buffer;
+
+            writeNdjsonResult(buffer, input, result, {}, paged ? &next : nullptr);
+
+            std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+            return EXIT_SUCCESS;
+        }
+
+        const auto solutions = [&opts, &result]()
+        {
+            std::vector<std::string> buffer(result.solutions.size());
+
+            if (opts.format == batch_format::infix)
+            {
+                const infix_renderer renderer(result.input);
+
+                for (decltype(buffer.size()) i(0); i < buffer.size(); ++i) renderer.write(buffer[i], result.solutions[i]);
+            }
+            else for (decltype(buffer.size()) i(0); i < buffer.size(); ++i)
+            {
+                std::stringstream ss;
+
+                formatSolutionTrace(ss, result.input, result.solutions[i]);
+
+                buffer[i] = ss.str();
+            }
+
+            return buffer;
+        }();
 
         const auto end_time(std::chrono::steady_clock::now());
 
         const auto size = solutions.size(); 
 
-        for (auto solution : solutions) std::cout << solution << "==========" << std::endl;
+        if (opts.format == batch_format::infix) for (const auto &solution : solutions) std::cout << solution << "\n";
+        else for (auto solution : solutions) std::cout << solution << "==========" << std::endl;
         
         std::cout << (!size ? "No solution" : [&size]()
         { 
@@ -319,6 +870,16 @@ int main(int argc, char **argv)
             return ss.str();
         }()
         << std::endl;
+
+        if (opts.sample && distinct) std::cout << "drawn from " << distinct << " distinct solution" << (distinct > 1 ? "s" : "") << " with seed " << opts.seed << std::endl;
+
+        if (opts.any) std::cout << "searched " << stats.nodes << " working sets, pruned " << stats.prunedEqualValues + stats.prunedEqualResults
+            << " branches (" << stats.prunedEqualValues << " equal values, " << stats.prunedEqualResults << " equal results)" << std::endl;
+
+        if (opts.rateDifficulty && rating.solutions) std::cout << "difficulty " << rating.score() << ": " << rating.fractionalSolutions << " of " << rating.solutions
+            << " distinct solutions pass through a non-integer, the shallowest is " << rating.minimumDepth << " operation" << (rating.minimumDepth != 1 ? "s" : "") << " deep" << std::endl;
+
+        if (paged) std::cout << (next.empty() ? std::string("last page") : "next page: --cursor " + next) << std::endl;
     }
     catch (const std::runtime_error &e)
     {
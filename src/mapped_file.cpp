@@ -0,0 +1,64 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <mapped_file.h>
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define N24_HAS_MMAP 1
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+mapped_file::mapped_file(const std::string &path, const bool sequential)
+{
+#ifdef N24_HAS_MMAP
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+
+    if (descriptor < 0) throw std::runtime_error(std::string("could not open file: ") + path);
+
+    struct stat status;
+
+    if (::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        m_Mapped = true;
+
+        if (status.st_size > 0)
+        {
+            m_Size = static_cast<std::size_t>(status.st_size);
+
+            void *address = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+            if (address == MAP_FAILED)
+            {
+                m_Size = 0;
+
+                m_Mapped = false;
+            }
+            else
+            {
+                if (sequential) ::madvise(address, m_Size, MADV_SEQUENTIAL);
+
+                m_Data = static_cast<const char *>(address);
+            }
+        }
+    }
+
+    ::close(descriptor);
+#else
+    static_cast<void>(sequential);
+
+    if (!std::ifstream(path, std::ios::binary)) throw std::runtime_error(std::string("could not open file: ") + path);
+#endif
+}
+
+mapped_file::~mapped_file()
+{
+#ifdef N24_HAS_MMAP
+    if (m_Data) ::munmap(const_cast<char *>(m_Data), m_Size);
+#endif
+}
@@ -0,0 +1,109 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <multiset_rank.h>
+
+#include <algorithm>
+#include <limits>
+
+multiset_index::multiset_index(const std::size_t size, const int low, const int high)
+: m_Size(size)
+, m_Low(low)
+, m_High(high)
+{
+    if (!size || low > high) throw std::runtime_error("multiset_index: there are no hands");
+
+    static constexpr auto SATURATED = std::numeric_limits<std::uint64_t>::max();
+
+    // c_i ranges over [0, values + size - 1)
+    const auto n = static_cast<std::size_t>(static_cast<std::int64_t>(high) - low) + size;
+
+    m_Binomial.assign(size + 1, std::vector<std::uint64_t>(n + 1, 0));
+
+    for (std::size_t i(0); i <= n; ++i)
+    {
+        m_Binomial[0][i] = 1;
+
+        for (std::size_t r(1); r <= size && r <= i; ++r)
+        {
+            const auto a = m_Binomial[r - 1][i - 1], b = m_Binomial[r][i - 1];
+
+            m_Binomial[r][i] = a > SATURATED - b ? SATURATED : a + b;
+        }
+    }
+
+    // hands are the size-subsets of the n positions
+    m_Count = m_Binomial[size][n];
+
+    if (m_Count == SATURATED)
+    {
+        std::stringstream ss;
+
+        ss << "multiset_index: too many hands of " << size << " integers in [" << low << ", " << high << "]";
+
+        throw std::runtime_error(ss.str());
+    }
+}
+
+std::uint64_t multiset_index::count() const
+{
+    return m_Count;
+}
+
+std::size_t multiset_index::size() const
+{
+    return m_Size;
+}
+
+int multiset_index::low() const
+{
+    return m_Low;
+}
+
+int multiset_index::high() const
+{
+    return m_High;
+}
+
+std::uint64_t multiset_index::rank(const input_collection_type &hand) const
+{
+    if (hand.size() != m_Size) throw std::runtime_error("multiset_index::rank: hand is the wrong size");
+
+    std::uint64_t after(0);
+
+    for (std::size_t i(0); i < m_Size; ++i)
+    {
+        const auto value = hand[m_Size - 1 - i];
+
+        if (!(value >= m_Low && value <= m_High) || value != static_cast<int>(value)) throw std::runtime_error("multiset_index::rank: hand holds a value out of range");
+
+        after += m_Binomial[i + 1][static_cast<std::size_t>(m_High - static_cast<int>(value)) + i];
+    }
+
+    return m_Count - 1 - after;
+}
+
+input_collection_type multiset_index::unrank(const std::uint64_t rank) const
+{
+    if (rank >= m_Count) throw std::runtime_error("multiset_index::unrank: rank out of range");
+
+    input_collection_type output(m_Size);
+
+    auto after = m_Count - 1 - rank;
+
+    // the largest c_i first: the greatest c with C(c, i + 1) <= after, no greater than c_{i+1} - 1
+    auto bound = m_Binomial[0].size() - 1;
+
+    for (auto i = m_Size; i-- > 0;)
+    {
+        const auto &column = m_Binomial[i + 1];
+
+        const auto c = static_cast<std::size_t>(std::upper_bound(column.begin() + i, column.begin() + bound, after) - column.begin()) - 1;
+
+        after -= column[c];
+
+        output[m_Size - 1 - i] = m_High - static_cast<int>(c - i);
+
+        bound = c;
+    }
+
+    return output;
+}
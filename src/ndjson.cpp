@@ -0,0 +1,207 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <expression.h>
+#include <ndjson.h>
+
+#include <array>
+#include <charconv>
+#include <cmath>
+
+json_writer::json_writer(std::string &buffer)
+: m_Buffer(buffer)
+{}
+
+void json_writer::separate()
+{
+    const auto bit = std::uint64_t(1) << m_Depth;
+
+    if (m_NeedsSeparator & bit) m_Buffer += ',';
+
+    m_NeedsSeparator |= bit;
+}
+
+void json_writer::open(const char c)
+{
+    separate();
+
+    m_Buffer += c;
+
+    if (++m_Depth >= 64) throw std::runtime_error("json_writer: nesting too deep");
+
+    m_NeedsSeparator &= ~(std::uint64_t(1) << m_Depth);
+}
+
+void json_writer::close(const char c)
+{
+    --m_Depth;
+
+    m_Buffer += c;
+}
+
+void json_writer::beginObject() { open('{'); }
+
+void json_writer::endObject() { close('}'); }
+
+void json_writer::beginArray() { open('['); }
+
+void json_writer::endArray() { close(']'); }
+
+void json_writer::key(const char *name)
+{
+    separate();
+
+    m_Buffer += '"';
+    m_Buffer += name;
+    m_Buffer += "\":";
+
+    m_NeedsSeparator &= ~(std::uint64_t(1) << m_Depth); // the value belongs to this key
+}
+
+void json_writer::value(const input_type number)
+{
+    separate();
+
+    if (std::isfinite(number)) writeNumber(m_Buffer, number);
+    else m_Buffer += "null";
+}
+
+void json_writer::value(const std::uint64_t number)
+{
+    separate();
+
+    std::array<char, 24> characters;
+
+    const auto result = std::to_chars(characters.data(), characters.data() + characters.size(), number);
+
+    m_Buffer.append(characters.data(), result.ptr);
+}
+
+void json_writer::value(const std::string &text)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    separate();
+
+    m_Buffer += '"';
+
+    for (const char c : text)
+    {
+        switch (c)
+        {
+            case '"': m_Buffer += "\\\""; break;
+            case '\\': m_Buffer += "\\\\"; break;
+            case '\n': m_Buffer += "\\n"; break;
+            case '\r': m_Buffer += "\\r"; break;
+            case '\t': m_Buffer += "\\t"; break;
+
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    m_Buffer += "\\u00";
+                    m_Buffer += hex[(c >> 4) & 0xF];
+                    m_Buffer += hex[c & 0xF];
+                }
+                else m_Buffer += c;
+        }
+    }
+
+    m_Buffer += '"';
+}
+
+void json_writer::beginRawString()
+{
+    separate();
+
+    m_Buffer += '"';
+}
+
+void json_writer::endRawString()
+{
+    m_Buffer += '"';
+}
+
+void json_writer::null()
+{
+    separate();
+
+    m_Buffer += "null";
+}
+
+std::string &json_writer::buffer()
+{
+    return m_Buffer;
+}
+
+void writeNdjsonResult(std::string &buffer, const input_collection_type &input, const solution_set &result, const std::string &error, const std::string *next)
+{
+    json_writer json(buffer);
+
+    json.beginObject();
+
+    json.key("input");
+    json.beginArray();
+    for (const auto value : input) json.value(value);
+    json.endArray();
+
+    json.key("target");
+    json.value(result.target);
+
+    json.key("count");
+    json.value(static_cast<std::uint64_t>(result.solutions.size()));
+
+    json.key("solutions");
+    json.beginArray();
+    const infix_renderer renderer(result.input);
+    for (const auto &s : result.solutions)
+    {
+        json.beginRawString();
+        renderer.write(json.buffer(), s);
+        json.endRawString();
+    }
+    json.endArray();
+
+    if (next)
+    {
+        json.key("next");
+
+        if (next->empty()) json.null();
+        else json.value(*next);
+    }
+
+    if (!error.empty())
+    {
+        json.key("error");
+        json.value(error);
+    }
+
+    json.endObject();
+
+    buffer += '\n';
+}
+
+void writeNdjsonCount(std::string &buffer, const input_collection_type &input, const input_type target, const std::uint64_t count, const std::string &error)
+{
+    json_writer json(buffer);
+
+    json.beginObject();
+
+    json.key("input");
+    json.beginArray();
+    for (const auto value : input) json.value(value);
+    json.endArray();
+
+    json.key("target");
+    json.value(target);
+
+    json.key("count");
+    json.value(count);
+
+    if (!error.empty())
+    {
+        json.key("error");
+        json.value(error);
+    }
+
+    json.endObject();
+
+    buffer += '\n';
+}
@@ -0,0 +1,251 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <expression_tables.h>
+#include <pairwise_search.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    static constexpr std::uint8_t leaf = 0xFF;
+
+    static constexpr std::size_t RESULTS_PER_PAIR = 6;
+
+    /// \brief node of the expression being built. Leaves are the inputs, in sorted order
+    struct search_node
+    {
+        std::uint8_t left; //!< leaf, or index of the left child
+        std::uint8_t right; //!< operand index for leaves, otherwise index of the right child
+
+        Operation operation;
+    };
+
+    struct working_value
+    {
+        input_type value;
+
+        std::uint64_t key; //!< valueKey(value): the working set is sorted by it, equal keys are interchangeable
+
+        std::uint8_t node;
+    };
+
+    using working_set = std::array<working_value, solution::max_operands>;
+
+    class pairwise_search final
+    {
+        const input_type m_Target;
+
+        search_stats &m_Stats;
+
+        std::array<search_node, solution::max_operands * 2 - 1> m_Nodes;
+
+        std::uint8_t m_NodeCount;
+
+    public:
+        pairwise_search(const input_type target, const std::size_t size, search_stats &stats)
+        : m_Target(target)
+        , m_Stats(stats)
+        , m_NodeCount(static_cast<std::uint8_t>(size))
+        {
+            for (std::uint8_t i(0); i < size; ++i) m_Nodes[i] = {leaf, i, Operation::Addition};
+        }
+
+        const search_node &node(const std::uint8_t index) const
+        {
+            return m_Nodes[index];
+        }
+
+        /// \brief true if the working set can reach the target. On success the root of the expression is working[0] of the last level
+        bool search(const working_set &working, const std::size_t size, std::uint8_t &root)
+        {
+            ++m_Stats.nodes;
+
+            if (size == 1)
+            {
+                root = working[0].node;
+
+                return working[0].value == m_Target;
+            }
+
+            working_set rest;
+
+            for (std::size_t i(0); i + 1 < size; ++i)
+            {
+                // every pair of i with a later value is skipped, each counted once: pairs with earlier values were counted from their side
+                if (i && working[i].key == working[i - 1].key)
+                {
+                    m_Stats.prunedEqualValues += size - 1 - i;
+
+                    continue;
+                }
+
+                for (std::size_t j(i + 1); j < size; ++j)
+                {
+                    if (j > i + 1 && working[j].key == working[j - 1].key)
+                    {
+                        ++m_Stats.prunedEqualValues;
+
+                        continue;
+                    }
+
+                    const auto &a = working[i], &b = working[j];
+
+                    const std::array<search_node, RESULTS_PER_PAIR> candidates{{
+                        {a.node, b.node, Operation::Addition},
+                        {a.node, b.node, Operation::Multiplication},
+                        {a.node, b.node, Operation::Subtraction},
+                        {b.node, a.node, Operation::Subtraction},
+                        {a.node, b.node, Operation::Division},
+                        {b.node, a.node, Operation::Division}}};
+
+                    std::array<std::uint64_t, RESULTS_PER_PAIR> tried;
+
+                    std::size_t triedCount(0);
+
+                    for (const auto &candidate : candidates)
+                    {
+                        const auto &l = candidate.left == a.node ? a : b, &r = candidate.left == a.node ? b : a;
+
+                        const auto value = Operation_PerformOperation(l.value, r.value, candidate.operation);
+
+                        if (std::isnan(value)) continue; // NaN is never equal to the target
+
+                        const auto key = valueKey(value);
+
+                        if (std::find(tried.begin(), tried.begin() + triedCount, key) != tried.begin() + triedCount)
+                        {
+                            ++m_Stats.prunedEqualResults;
+
+                            continue;
+                        }
+
+                        tried[triedCount++] = key;
+
+                        // the rest of the working set stays sorted, the result is inserted in order
+                        const working_value result{value, key, m_NodeCount};
+
+                        std::size_t restSize(0);
+
+                        bool inserted(false);
+
+                        for (std::size_t k(0); k < size; ++k)
+                        {
+                            if (k == i || k == j) continue;
+
+                            if (!inserted && key < working[k].key)
+                            {
+                                rest[restSize++] = result;
+
+                                inserted = true;
+                            }
+
+                            rest[restSize++] = working[k];
+                        }
+
+                        if (!inserted) rest[restSize++] = result;
+
+                        m_Nodes[m_NodeCount++] = candidate;
+
+                        if (search(rest, restSize, root)) return true;
+
+                        --m_NodeCount;
+                    }
+                }
+            }
+
+            return false;
+        }
+    };
+}
+
+solution_set findAnySolution(const input_type targetNumber, input_collection_type input, search_stats *stats)
+{
+    solution_set output{targetNumber, {}, {}};
+
+    std::sort(input.begin(), input.end());
+
+    output.input = input;
+
+    if (!input.size()) return output;
+    else if (input.size() > solution::max_operands) throw std::runtime_error([&input]()
+    {
+        std::stringstream ss;
+
+        ss << "findAnySolution: input of size " << input.size() << " exceeds the maximum of " << solution::max_operands;
+
+        return ss.str();
+    }());
+
+    search_stats localStats;
+
+    auto &searchStats = stats ? *stats : localStats;
+
+    pairwise_search search(targetNumber, input.size(), searchStats);
+
+    working_set working;
+
+    for (std::uint8_t i(0); i < input.size(); ++i) working[i] = {input[i], valueKey(input[i]), i};
+
+    std::sort(working.begin(), working.begin() + input.size(), [](const working_value &a, const working_value &b) { return a.key < b.key; });
+
+    std::uint8_t root;
+
+    if (!search.search(working, input.size(), root)) return output;
+
+    //
+    // Convert the expression tree to the compact form: operands in the order they appear,
+    // then each operation in post order, combining its children, which are adjacent by then
+    //
+    solution s;
+
+    s.size = static_cast<std::uint8_t>(input.size());
+
+    std::array<std::uint8_t, solution::max_operands> current;
+
+    std::uint8_t currentSize(0), stepCount(0);
+
+    const auto collectOperands = [&](const auto &self, const std::uint8_t index) -> void
+    {
+        const auto &n = search.node(index);
+
+        if (n.left == leaf)
+        {
+            s.operands[currentSize] = n.right;
+
+            current[currentSize++] = index;
+        }
+        else
+        {
+            self(self, n.left);
+            self(self, n.right);
+        }
+    };
+
+    collectOperands(collectOperands, root);
+
+    const auto collectSteps = [&](const auto &self, const std::uint8_t index) -> void
+    {
+        const auto &n = search.node(index);
+
+        if (n.left == leaf) return;
+
+        self(self, n.left);
+        self(self, n.right);
+
+        const auto position = static_cast<std::uint8_t>(std::find(current.begin(), current.begin() + currentSize, n.left) - current.begin());
+
+        s.steps[stepCount++] = {position, n.operation};
+
+        current[position] = index;
+
+        std::copy(current.begin() + position + 2, current.begin() + currentSize, current.begin() + position + 1);
+
+        --currentSize;
+    };
+
+    collectSteps(collectSteps, root);
+
+    output.solutions.push_back(s);
+
+    return output;
+}
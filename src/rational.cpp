@@ -0,0 +1,178 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <rational.h>
+#include <expression.h>
+
+#include <cctype>
+#include <limits>
+#include <string>
+
+namespace
+{
+    std::uint64_t magnitude(const std::int64_t value)
+    {
+        return value < 0 ? std::uint64_t(0) - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    }
+
+    std::uint64_t gcd(std::uint64_t a, std::uint64_t b)
+    {
+        while (b)
+        {
+            const auto t = a % b;
+
+            a = b;
+            b = t;
+        }
+
+        return a;
+    }
+}
+
+bool checkedAdd(const std::int64_t a, const std::int64_t b, std::int64_t &output)
+{
+    if ((b > 0 && a > std::numeric_limits<std::int64_t>::max() - b) || (b < 0 && a < std::numeric_limits<std::int64_t>::min() - b)) return false;
+
+    output = a + b;
+
+    return true;
+}
+
+bool checkedMultiply(const std::int64_t a, const std::int64_t b, std::int64_t &output)
+{
+    if (!a || !b)
+    {
+        output = 0;
+
+        return true;
+    }
+
+    const auto x = magnitude(a), y = magnitude(b);
+
+    if (x > std::numeric_limits<std::uint64_t>::max() / y) return false;
+
+    const auto product = x * y;
+
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + ((a < 0) != (b < 0) ? 1 : 0);
+
+    if (product > limit) return false;
+
+    // the negative product is formed in unsigned arithmetic, as the magnitude of the minimum has no positive counterpart
+    output = (a < 0) != (b < 0) ? static_cast<std::int64_t>(std::uint64_t(0) - product) : static_cast<std::int64_t>(product);
+
+    return true;
+}
+
+bool makeRational(std::int64_t numerator, std::int64_t denominator, rational &output)
+{
+    if (!denominator) return false;
+
+    if (!numerator)
+    {
+        output = {0, 1};
+
+        return true;
+    }
+
+    const auto common = gcd(magnitude(numerator), magnitude(denominator));
+
+    // a common factor of 2^63 needs both magnitudes to be 2^63, as neither is 0
+    if (common > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+    {
+        output = {1, 1};
+
+        return true;
+    }
+
+    const auto divisor = static_cast<std::int64_t>(common);
+
+    // the divisor is 1 unless both magnitudes share a factor, so the only quotient that cannot be negated is minimum / 1
+    numerator /= divisor;
+    denominator /= divisor;
+
+    if (denominator < 0)
+    {
+        if (numerator == std::numeric_limits<std::int64_t>::min() || denominator == std::numeric_limits<std::int64_t>::min()) return false;
+
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+
+    output = {numerator, denominator};
+
+    return true;
+}
+
+bool applyOperation(const rational &l, const rational &r, const Operation operation, rational &output)
+{
+    std::int64_t a, b, c;
+
+    switch (operation)
+    {
+        case Operation::Addition:
+        case Operation::Subtraction:
+        {
+            if (!checkedMultiply(l.numerator, r.denominator, a) || !checkedMultiply(r.numerator, l.denominator, b) || !checkedMultiply(l.denominator, r.denominator, c)) return false;
+
+            if (operation == Operation::Subtraction && !checkedMultiply(b, -1, b)) return false;
+
+            return checkedAdd(a, b, a) && makeRational(a, c, output);
+        }
+        case Operation::Multiplication:
+            return checkedMultiply(l.numerator, r.numerator, a) && checkedMultiply(l.denominator, r.denominator, b) && makeRational(a, b, output);
+
+        case Operation::Division:
+            return r.numerator && checkedMultiply(l.numerator, r.denominator, a) && checkedMultiply(l.denominator, r.numerator, b) && makeRational(a, b, output);
+
+        default: return false;
+    }
+}
+
+bool decimalRational(const input_type value, rational &output)
+{
+    std::string text;
+
+    writeNumber(text, value);
+
+    std::size_t i(0);
+
+    const bool negative = i < text.size() && text[i] == '-';
+
+    if (negative) ++i;
+
+    std::int64_t digits(0), scale(1);
+
+    bool any(false), fraction(false);
+
+    for (; i < text.size() && (std::isdigit(static_cast<unsigned char>(text[i])) || (text[i] == '.' && !fraction)); ++i)
+    {
+        if (text[i] == '.')
+        {
+            fraction = true;
+
+            continue;
+        }
+
+        any = true;
+
+        if (!checkedMultiply(digits, 10, digits) || !checkedAdd(digits, text[i] - '0', digits)) return false;
+
+        if (fraction && !checkedMultiply(scale, 10, scale)) return false;
+    }
+
+    if (!any) return false; // inf or nan
+
+    if (i < text.size() && text[i] == 'e')
+    {
+        const bool negativeExponent = ++i < text.size() && text[i] == '-';
+
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) ++i;
+
+        const auto exponent = std::stoi(text.substr(i));
+
+        if (digits) for (int e(0); e < exponent; ++e)
+        {
+            if (!checkedMultiply(negativeExponent ? scale : digits, 10, negativeExponent ? scale : digits)) return false;
+        }
+    }
+
+    return makeRational(negative ? -digits : digits, scale, output);
+}
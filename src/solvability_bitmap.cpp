@@ -0,0 +1,260 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <solvability_bitmap.h>
+#include <expression_tables.h>
+#include <table_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    static constexpr std::size_t WORDS_PER_BLOCK = solvability_bitmap::BLOCK_BITS / 64;
+
+    std::uint64_t wordCount(const std::uint64_t bits)
+    {
+        return (bits + 63) / 64;
+    }
+
+    std::uint64_t directorySize(const std::uint64_t bits)
+    {
+        return (bits + solvability_bitmap::BLOCK_BITS - 1) / solvability_bitmap::BLOCK_BITS + 1;
+    }
+
+    /// \brief number of set bits
+    std::uint64_t popcount(std::uint64_t word)
+    {
+        // sums of bits in pairs, nibbles, then bytes, gathered into the top byte by the multiplication
+        word -= (word >> 1) & 0x5555555555555555ull;
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+
+        return (word * 0x0101010101010101ull) >> 56;
+    }
+
+    /// \brief position of the lowest set bit of word, which must not be 0
+    unsigned trailingZeros(const std::uint64_t word)
+    {
+        return static_cast<unsigned>(popcount((word & (~word + 1)) - 1));
+    }
+
+    /// \brief position of the k-th set bit of word, which must have more than k set bits
+    unsigned selectInWord(std::uint64_t word, std::uint64_t k)
+    {
+        for (; k; --k) word &= word - 1;
+
+        return trailingZeros(word);
+    }
+}
+
+solvability_bitmap::solvability_bitmap(const multiset_index &hands, const input_type target, std::vector<std::uint64_t> words)
+: m_Header{}
+, m_Storage(std::move(words))
+, m_File()
+{
+    const auto bits = hands.count();
+
+    if (m_Storage.size() != wordCount(bits)) throw std::runtime_error("solvability_bitmap: wrong number of words");
+
+    std::copy(std::begin(solvability_bitmap_magic), std::end(solvability_bitmap_magic), m_Header.magic);
+
+    m_Header.version = solvability_bitmap_version;
+    m_Header.size = static_cast<std::uint32_t>(hands.size());
+    m_Header.low = hands.low();
+    m_Header.high = hands.high();
+    m_Header.target = target;
+    m_Header.bit_count = bits;
+
+    // bits past the last hand are clear
+    if (bits % 64) m_Storage.back() &= (std::uint64_t(1) << bits % 64) - 1;
+
+    const auto wordTotal = m_Storage.size();
+
+    std::uint64_t ones(0);
+
+    for (std::size_t w(0); w < wordTotal; ++w)
+    {
+        if (w % WORDS_PER_BLOCK == 0) m_Storage.push_back(ones);
+
+        ones += popcount(m_Storage[w]);
+    }
+
+    m_Storage.push_back(ones);
+
+    m_Header.one_count = ones;
+
+    m_Words = m_Storage.data();
+    m_Directory = m_Storage.data() + wordTotal;
+}
+
+solvability_bitmap::solvability_bitmap(const std::string &path)
+: m_Header{}
+, m_File(std::make_unique<mapped_file>(path))
+{
+    const auto fail = [&path](const char *reason)
+    {
+        std::stringstream ss;
+
+        ss << "solvability_bitmap: " << path << " " << reason;
+
+        throw std::runtime_error(ss.str());
+    };
+
+    const char *data = m_File->begin();
+
+    auto size = m_File->size();
+
+    if (!m_File->mapped())
+    {
+        // not mappable, such as a pipe: read into storage of whole words, which keeps the words aligned
+        std::ifstream stream(path, std::ios::binary);
+
+        const std::string bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        m_Storage.resize((bytes.size() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+
+        std::memcpy(m_Storage.data(), bytes.data(), bytes.size());
+
+        data = reinterpret_cast<const char *>(m_Storage.data());
+
+        size = bytes.size();
+    }
+
+    if (size < sizeof(m_Header)) fail("is too short");
+
+    std::memcpy(&m_Header, data, sizeof(m_Header));
+
+    if (!std::equal(std::begin(solvability_bitmap_magic), std::end(solvability_bitmap_magic), m_Header.magic)) fail("is not a solvability bitmap");
+
+    if (m_Header.version != solvability_bitmap_version) fail("has an unsupported version");
+
+    if (hands().count() != m_Header.bit_count) fail("does not have one bit per hand");
+
+    const auto words = wordCount(m_Header.bit_count);
+
+    if (size != sizeof(m_Header) + (words + directorySize(m_Header.bit_count)) * sizeof(std::uint64_t)) fail("has the wrong size");
+
+    // the header is a multiple of 8 bytes and mappings are page aligned
+    m_Words = reinterpret_cast<const std::uint64_t *>(data + sizeof(m_Header));
+    m_Directory = m_Words + words;
+
+    // rank and select trust the directory, so it must agree with the words
+    if (m_Header.bit_count % 64 && m_Words[words - 1] >> m_Header.bit_count % 64) fail("has bits set past the last hand");
+
+    std::uint64_t ones(0);
+
+    for (std::uint64_t w(0); w < words; ++w)
+    {
+        if (w % WORDS_PER_BLOCK == 0 && m_Directory[w / WORDS_PER_BLOCK] != ones) fail("has a directory that does not match its bits");
+
+        ones += popcount(m_Words[w]);
+    }
+
+    if (m_Directory[directorySize(m_Header.bit_count) - 1] != ones || m_Header.one_count != ones) fail("has a directory that does not match its bits");
+}
+
+const solvability_bitmap_header &solvability_bitmap::header() const
+{
+    return m_Header;
+}
+
+multiset_index solvability_bitmap::hands() const
+{
+    return multiset_index(m_Header.size, m_Header.low, m_Header.high);
+}
+
+bool solvability_bitmap::test(const std::uint64_t i) const
+{
+    return i < m_Header.bit_count && (m_Words[i / 64] >> (i % 64) & 1);
+}
+
+std::uint64_t solvability_bitmap::rank(std::uint64_t i) const
+{
+    i = std::min(i, m_Header.bit_count);
+
+    const auto block = i / BLOCK_BITS;
+
+    auto output = m_Directory[block];
+
+    for (auto w = block * WORDS_PER_BLOCK; w < i / 64; ++w) output += popcount(m_Words[w]);
+
+    if (i % 64) output += popcount(m_Words[i / 64] & ((std::uint64_t(1) << i % 64) - 1));
+
+    return output;
+}
+
+std::uint64_t solvability_bitmap::select(std::uint64_t k) const
+{
+    if (k >= m_Header.one_count) throw std::runtime_error("solvability_bitmap::select: there are not that many solvable hands");
+
+    const auto blocks = directorySize(m_Header.bit_count);
+
+    // the last block whose count of set bits before it is at most k
+    const auto block = static_cast<std::uint64_t>(std::upper_bound(m_Directory, m_Directory + blocks, k) - m_Directory) - 1;
+
+    k -= m_Directory[block];
+
+    for (auto w = block * WORDS_PER_BLOCK; w < wordCount(m_Header.bit_count); ++w)
+    {
+        const auto ones = popcount(m_Words[w]);
+
+        if (k < ones) return w * 64 + selectInWord(m_Words[w], k);
+
+        k -= ones;
+    }
+
+    throw std::out_of_range("solvability_bitmap::select: the directory counts more set bits than the words hold");
+}
+
+void solvability_bitmap::write(std::FILE *output) const
+{
+    std::fwrite(&m_Header, sizeof(m_Header), 1, output);
+
+    std::fwrite(m_Words, sizeof(std::uint64_t), wordCount(m_Header.bit_count), output);
+
+    std::fwrite(m_Directory, sizeof(std::uint64_t), directorySize(m_Header.bit_count), output);
+}
+
+solvability_bitmap buildSolvabilityBitmap(const input_type targetNumber, const std::size_t size, const int low, const int high, unsigned threads, const std::size_t cacheCapacity)
+{
+    const multiset_index hands(size, low, high);
+
+    std::vector<std::uint64_t> words(wordCount(hands.count()), 0);
+
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    table_cache cache(cacheCapacity);
+
+    std::atomic<std::size_t> nextWord{0};
+
+    // each thread fills whole words, 64 consecutive hands that share most of their sub-multisets
+    const auto fill = [&]()
+    {
+        for (std::size_t w; (w = nextWord.fetch_add(1, std::memory_order_relaxed)) < words.size();)
+        {
+            std::uint64_t word(0);
+
+            for (std::uint64_t bit(0), rank(w * 64); bit < 64 && rank < hands.count(); ++bit, ++rank)
+            {
+                if (isReachable(targetNumber, hands.unrank(rank), &cache)) word |= std::uint64_t(1) << bit;
+            }
+
+            words[w] = word;
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned i(1); i < threads; ++i) workers.emplace_back(fill);
+
+    fill();
+
+    for (auto &worker : workers) worker.join();
+
+    return solvability_bitmap(hands, targetNumber, std::move(words));
+}
@@ -0,0 +1,661 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+/// \brief brute force calculator for 24 game, extended to N game
+///
+/// 24 game rules:
+///  given a set of 4 real numbers, the player must create an expression that evaluates to 24
+///  each number MUST be used EXACTLY once.
+///  legal operations are +, -, /, *.
+///  operations can be used any number of times and in any order.
+///
+/// The rules have been extended so that:
+///     the target number "24" can be substituted for any other real number.
+///     the user can be given any number of floating point numbers, they are not limited to 4
+///
+/// How the calculator works:
+///   1) a table of every valid postfix program for the given number of operands is generated, once per number of operands.
+///      A program is a sequence of operand pushes and operators, e.g: given {1, 2, 5}, the programs are "1 2 5 op op" and "1 2 op 5 op",
+///      which are the two ways of bracketing three operands: 1 op (2 op 5) and (1 op 2) op 5.
+///   2) each program is run with every configuration of operations, {+, +}, {+, -}, ..., {/, /}, on every permutation of the input set,
+///      evaluating on a small fixed size stack. Configurations share the evaluation of the operators they have in common.
+///      If the resulting expression is equal to 24, that expression is added to the set of solutions, otherwise it is discarded.
+///      Every expression is visited exactly once.
+///   3) each solution is then displayed, along with the number of solutions and the amount of time it took the machine to calculate them.
+///
+#include <solver.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <unordered_set>
+
+namespace
+{
+    /// \brief every valid postfix program of an expression over size operands, in increasing order.
+    /// Bit t of a program is set if token t is an operator, otherwise it pushes the next operand.
+    /// Tables are generated on first use and shared by all threads
+    const std::vector<std::uint32_t> &postfixPrograms(const std::size_t size)
+    {
+        static std::array<std::vector<std::uint32_t>, solution::max_operands + 1> tables;
+
+        static std::array<std::once_flag, solution::max_operands + 1> generated;
+
+        std::call_once(generated[size], [size]()
+        {
+            auto &table = tables[size];
+
+            const auto tokenCount = 2 * size - 1;
+
+            // depth is the height of the value stack after the tokens placed so far
+            const auto generate = [&](const auto &self, const std::size_t token, const std::size_t pushed, const std::size_t depth, const std::uint32_t program) -> void
+            {
+                if (token == tokenCount)
+                {
+                    table.push_back(program);
+
+                    return;
+                }
+
+                if (pushed < size) self(self, token + 1, pushed + 1, depth + 1, program);
+
+                if (depth >= 2) self(self, token + 1, pushed, depth - 1, program | (std::uint32_t(1) << token));
+            };
+
+            generate(generate, 0, 0, 0, 0);
+
+            std::sort(table.begin(), table.end());
+        });
+
+        return tables[size];
+    }
+
+    /// \brief enumeration order of the brute force search, starting at position start.
+    /// A position is (permutation rank * program count + program) * operation configuration count + operation configuration,
+    /// where the operation of the first operator is the most significant digit of the configuration.
+    /// visit(solution, position) is called for every solution found and returns false to stop the search.
+    /// input must be sorted and contain at least 2 numbers
+    template<class Visit>
+    void enumerateSolutions(const input_type targetNumber, const input_collection_type &input, const std::uint64_t start, Visit &&visit)
+    {
+        const auto size(input.size());
+
+        const auto NUMBER_OF_OPERATIONS_IN_EXPRESSION(size - 1);
+
+        const auto &programs = postfixPrograms(size);
+
+        std::uint64_t operationCount(1);
+
+        for (std::size_t i(0); i < NUMBER_OF_OPERATIONS_IN_EXPRESSION; ++i) operationCount *= Operation_Count;
+
+        const std::uint64_t programCount(programs.size());
+
+        std::array<std::uint8_t, solution::max_operands> permutation;
+
+        unrankPermutation(input, start / operationCount / programCount, permutation.data());
+
+        auto position = start - start % (programCount * operationCount);
+
+        std::uint64_t firstProgram = start / operationCount % programCount, firstOperations = start % operationCount;
+
+        const auto byValue = [&input](const std::uint8_t a, const std::uint8_t b) { return input[a] < input[b]; };
+
+        solution candidate;
+
+        candidate.size = static_cast<std::uint8_t>(size);
+
+        bool running(true);
+
+        do
+        {
+            std::array<input_type, solution::max_operands> operands;
+
+            for (decltype(input.size()) i(0); i < size; ++i) operands[i] = input[permutation[i]];
+
+            candidate.operands = permutation;
+
+            for (auto p = firstProgram; running && p < programCount; ++p)
+            {
+                const auto program = programs[p];
+
+                const auto programPosition = position + p * operationCount;
+
+                // runs the program from token on, choosing an operation for each operator.
+                // configuration holds the operations chosen so far, remaining is the number of operators yet to choose
+                const auto run = [&](const auto &self, std::size_t token, std::size_t pushed, std::array<input_type, solution::max_operands> stack, std::size_t depth,
+                    const std::uint64_t configuration, const std::uint64_t remaining) -> void
+                {
+                    while (token < 2 * size - 1 && !(program >> token & 1))
+                    {
+                        stack[depth++] = operands[pushed++];
+
+                        ++token;
+                    }
+
+                    if (token == 2 * size - 1)
+                    {
+                        if (stack[0] == targetNumber && !visit(candidate, programPosition + configuration)) running = false;
+
+                        return;
+                    }
+
+                    const auto step = NUMBER_OF_OPERATIONS_IN_EXPRESSION - remaining;
+
+                    const auto left = stack[depth - 2], right = stack[depth - 1];
+
+                    std::uint64_t span(1);
+
+                    for (std::uint64_t i(1); i < remaining; ++i) span *= Operation_Count;
+
+                    for (std::size_t o(0); running && o < Operation_Count; ++o)
+                    {
+                        const auto next = configuration + o * span;
+
+                        if (next + span <= firstOperations) continue; // before the start position
+
+                        const auto operation = static_cast<Operation>(o);
+
+                        stack[depth - 2] = Operation_PerformOperation(left, right, operation);
+
+                        candidate.steps[step] = {static_cast<std::uint8_t>(depth - 2), operation};
+
+                        self(self, token + 1, pushed, stack, depth - 1, next, remaining - 1);
+                    }
+                };
+
+                run(run, 0, 0, {}, 0, 0, NUMBER_OF_OPERATIONS_IN_EXPRESSION);
+
+                firstOperations = 0;
+            }
+
+            firstProgram = 0;
+
+            position += programCount * operationCount;
+        }
+        while(running && std::next_permutation(permutation.begin(), permutation.begin() + size, byValue));
+    }
+}
+
+double difficulty::score() const
+{
+    if (!solutions) return 0;
+
+    std::size_t balancedDepth(0);
+
+    for (std::size_t leaves(1); leaves < size; leaves *= 2) ++balancedDepth;
+
+    return 1.0 / solutions + static_cast<double>(fractionalSolutions) / solutions + 0.5 * (minimumDepth - balancedDepth);
+}
+
+solution_set findSolutions(const input_type targetNumber, input_collection_type input, difficulty *rating)
+{
+    solution_set output{targetNumber, {}, {}};
+
+    std::sort(input.begin(), input.end()); //std::next_permutation requires sorted data
+
+    output.input = input;
+
+    if (rating) *rating = {input.size(), 0, 0, 0};
+
+    //
+    // 0. Handle trivial cases
+    //
+    if (!input.size()) return output;
+    else if (input.size() > solution::max_operands) throw std::runtime_error([&input]()
+    {
+        std::stringstream ss;
+
+        ss << "findSolutions: input of size " << input.size() << " exceeds the maximum of " << solution::max_operands;
+
+        return ss.str();
+    }());
+    else if (input.size() == 1)
+    {
+        if (input.front() == targetNumber)
+        {
+            solution s;
+
+            s.size = 1;
+            s.operands[0] = 0;
+
+            output.solutions.push_back(s);
+
+            if (rating) rating->solutions = 1;
+        }
+
+        return output;
+    }
+
+    enumerateSolutions(targetNumber, input, 0, [&output, &input, rating](const solution &s, std::uint64_t)
+    {
+        output.solutions.push_back(s);
+
+        if (!rating) return true;
+
+        // replays the steps of the solution just found, tracking the height of each working value
+        std::array<input_type, solution::max_operands> working;
+
+        std::array<std::uint8_t, solution::max_operands> height{};
+
+        for (std::uint8_t i(0); i < s.size; ++i) working[i] = input[s.operands[i]];
+
+        bool fractional(false);
+
+        for (std::uint8_t i(0), workingSize(s.size); i + 1 < s.size; ++i, --workingSize)
+        {
+            const auto &step = s.steps[i];
+
+            const auto value = Operation_PerformOperation(working[step.position], working[step.position + 1], step.operation);
+
+            if (i + 2 < s.size && !(std::isfinite(value) && value == std::floor(value))) fractional = true; // the last value is the target
+
+            working[step.position] = value;
+
+            height[step.position] = std::max(height[step.position], height[step.position + 1]) + 1;
+
+            std::move(working.begin() + step.position + 2, working.begin() + workingSize, working.begin() + step.position + 1);
+            std::move(height.begin() + step.position + 2, height.begin() + workingSize, height.begin() + step.position + 1);
+        }
+
+        rating->minimumDepth = rating->solutions ? std::min<std::size_t>(rating->minimumDepth, height[0]) : height[0];
+
+        ++rating->solutions;
+
+        if (fractional) ++rating->fractionalSolutions;
+
+        return true;
+    });
+
+    return output;
+}
+
+namespace
+{
+    /// \brief distinguishes cursors of different hands and targets
+    std::uint32_t fingerprint(const input_type targetNumber, const input_collection_type &input)
+    {
+        static constexpr std::uint8_t CURSOR_VERSION = 2; //!< positions in the postfix program enumeration
+
+        std::uint32_t hash((2166136261u ^ CURSOR_VERSION) * 16777619u);
+
+        const auto append = [&hash](const input_type value)
+        {
+            unsigned char bytes[sizeof(value)];
+
+            std::memcpy(bytes, &value, sizeof(value));
+
+            for (const auto b : bytes) hash = (hash ^ b) * 16777619u;
+        };
+
+        append(targetNumber);
+
+        for (const auto value : input) append(value);
+
+        return hash;
+    }
+
+    /// \brief number of positions in the enumeration order of an input of the given size, throws if it cannot be represented
+    std::uint64_t countPositions(const input_collection_type &input)
+    {
+        const std::size_t steps = input.size() - 1;
+
+        std::array<std::uint8_t, solution::max_operands> permutation;
+
+        for (decltype(input.size()) i(0); i < input.size(); ++i) permutation[i] = static_cast<std::uint8_t>(input.size() - 1 - i);
+
+        std::uint64_t output = rankPermutation(input, permutation.data(), input.size()) + 1; // rank of the last permutation
+
+        const auto multiply = [&output](const std::uint64_t factor)
+        {
+            if (output > ~std::uint64_t(0) / factor) throw std::runtime_error("findSolutionPage: input set is too large to page through");
+
+            output *= factor;
+        };
+
+        for (std::size_t i(0); i < steps; ++i) multiply(Operation_Count);
+
+        multiply(postfixPrograms(input.size()).size());
+
+        return output;
+    }
+
+    std::string encodeCursor(const std::uint64_t position, const std::uint32_t hand)
+    {
+        std::stringstream ss;
+
+        ss << std::hex << std::setfill('0') << std::setw(16) << position << std::setw(8) << hand;
+
+        return ss.str();
+    }
+
+    std::uint64_t decodeCursor(const std::string &cursor, const std::uint32_t hand)
+    {
+        if (cursor.empty()) return 0;
+
+        std::uint64_t position;
+
+        std::uint32_t cursorHand;
+
+        const auto parse = [&cursor](const std::size_t offset, const std::size_t length, auto &value)
+        {
+            const auto result = std::from_chars(cursor.data() + offset, cursor.data() + offset + length, value, 16);
+
+            return result.ec == std::errc() && result.ptr == cursor.data() + offset + length;
+        };
+
+        if (cursor.size() != 24 || !parse(0, 16, position) || !parse(16, 8, cursorHand) || cursorHand != hand)
+        {
+            throw std::runtime_error(std::string("invalid cursor for this hand: ") + cursor);
+        }
+
+        return position;
+    }
+}
+
+solution_page findSolutionPage(const input_type targetNumber, input_collection_type input, const std::string &cursor, const std::size_t pageSize)
+{
+    solution_page output{{targetNumber, {}, {}}, {}};
+
+    std::sort(input.begin(), input.end());
+
+    output.result.input = input;
+
+    const auto hand = fingerprint(targetNumber, input);
+
+    const auto start = decodeCursor(cursor, hand);
+
+    if (!pageSize) throw std::runtime_error("findSolutionPage: page size must be at least 1");
+
+    if (input.size() < 2)
+    {
+        if (!start) output.result = findSolutions(targetNumber, std::move(input));
+
+        return output;
+    }
+
+    if (input.size() > solution::max_operands || start >= countPositions(input)) return output;
+
+    auto &solutions = output.result.solutions;
+
+    enumerateSolutions(targetNumber, input, start, [&](const solution &s, const std::uint64_t position)
+    {
+        if (solutions.size() == pageSize)
+        {
+            output.next = encodeCursor(position, hand);
+
+            return false;
+        }
+
+        solutions.push_back(s);
+
+        return true;
+    });
+
+    return output;
+}
+
+namespace
+{
+    std::uint64_t factorial(std::size_t n)
+    {
+        std::uint64_t output(1);
+
+        while (n > 1) output *= n--;
+
+        return output;
+    }
+
+    /// \brief groups the sorted input into runs of equal values. group[i] is the run of input[i], counts holds the size of each run
+    void groupEqualValues(const input_collection_type &input, std::array<std::uint8_t, solution::max_operands> &group, std::array<std::uint8_t, solution::max_operands> &counts, std::size_t &groupCount)
+    {
+        groupCount = 0;
+
+        for (decltype(input.size()) i(0); i < input.size(); ++i)
+        {
+            if (!i || input[i] != input[i - 1]) counts[groupCount++] = 0;
+
+            group[i] = static_cast<std::uint8_t>(groupCount - 1);
+
+            ++counts[groupCount - 1];
+        }
+    }
+
+    /// \brief number of distinct orderings of a multiset with the given run sizes
+    std::uint64_t countPermutations(const std::array<std::uint8_t, solution::max_operands> &counts, const std::size_t groupCount, const std::size_t size)
+    {
+        auto output = factorial(size);
+
+        for (std::size_t g(0); g < groupCount; ++g) output /= factorial(counts[g]);
+
+        return output;
+    }
+}
+
+std::uint64_t rankPermutation(const input_collection_type &input, const std::uint8_t *operands, const std::size_t size)
+{
+    std::array<std::uint8_t, solution::max_operands> group, counts;
+
+    std::size_t groupCount;
+
+    groupEqualValues(input, group, counts, groupCount);
+
+    std::uint64_t rank(0);
+
+    for (std::size_t i(0); i < size; ++i)
+    {
+        const auto current = group[operands[i]];
+
+        for (std::size_t g(0); g < current; ++g)
+        {
+            if (!counts[g]) continue;
+
+            --counts[g];
+
+            rank += countPermutations(counts, groupCount, size - i - 1);
+
+            ++counts[g];
+        }
+
+        --counts[current];
+    }
+
+    return rank;
+}
+
+void unrankPermutation(const input_collection_type &input, std::uint64_t rank, std::uint8_t *operands)
+{
+    std::array<std::uint8_t, solution::max_operands> group, counts, nextIndex;
+
+    std::size_t groupCount;
+
+    groupEqualValues(input, group, counts, groupCount);
+
+    for (decltype(input.size()) i(input.size()); i-- > 0;) nextIndex[group[i]] = static_cast<std::uint8_t>(i);
+
+    const auto size = input.size();
+
+    for (std::size_t i(0); i < size; ++i)
+    {
+        for (std::size_t g(0); g < groupCount; ++g)
+        {
+            if (!counts[g]) continue;
+
+            --counts[g];
+
+            const auto block = countPermutations(counts, groupCount, size - i - 1);
+
+            if (rank < block)
+            {
+                operands[i] = nextIndex[g]++;
+
+                break;
+            }
+
+            rank -= block;
+
+            ++counts[g];
+        }
+    }
+}
+
+std::uint64_t encodeSolution(const input_collection_type &input, const solution &s)
+{
+    static constexpr std::uint64_t limit = std::uint64_t(1) << 60;
+
+    if (!s.size || s.size >= 16) return no_solution_code;
+
+    const std::size_t steps = s.size - 1;
+
+    auto code = rankPermutation(input, s.operands.data(), s.size);
+
+    const auto append = [&code](const std::uint64_t digit, const std::uint64_t radix)
+    {
+        if (code > (limit - 1 - digit) / radix) return false;
+
+        code = code * radix + digit;
+
+        return true;
+    };
+
+    for (std::size_t i(0); i < steps; ++i) if (!append(s.steps[i].position, steps - i)) return no_solution_code;
+
+    for (std::size_t i(0); i < steps; ++i) if (!append(static_cast<std::uint64_t>(s.steps[i].operation), Operation_Count)) return no_solution_code;
+
+    return (static_cast<std::uint64_t>(s.size) << 60) | code;
+}
+
+solution decodeSolution(const input_collection_type &input, std::uint64_t code)
+{
+    solution s;
+
+    s.size = static_cast<std::uint8_t>(code >> 60);
+
+    if (code == no_solution_code || s.size != input.size()) throw std::runtime_error("decodeSolution: code does not belong to this input set");
+
+    code &= (std::uint64_t(1) << 60) - 1;
+
+    const std::size_t steps = s.size - 1;
+
+    for (auto i = steps; i-- > 0;)
+    {
+        s.steps[i].operation = static_cast<Operation>(code % Operation_Count);
+
+        code /= Operation_Count;
+    }
+
+    for (auto i = steps; i-- > 0;)
+    {
+        s.steps[i].position = static_cast<std::uint8_t>(code % (steps - i));
+
+        code /= steps - i;
+    }
+
+    unrankPermutation(input, code, s.operands.data());
+
+    return s;
+}
+
+std::size_t distinctSolutionCount(const solution_set &result)
+{
+    static constexpr std::uint8_t operation_token = solution::max_operands; //!< operands are tokenized by their run of equal values, operations follow
+
+    std::array<std::uint8_t, solution::max_operands> group, counts;
+
+    std::size_t groupCount;
+
+    groupEqualValues(result.input, group, counts, groupCount);
+
+    std::unordered_set<std::string> expressions;
+
+    std::array<std::string, solution::max_operands> working;
+
+    for (const auto &s : result.solutions)
+    {
+        for (std::uint8_t i(0); i < s.size; ++i) working[i].assign(1, static_cast<char>(group[s.operands[i]]));
+
+        // postfix form of the expression tree: independent of the order in which the steps of the tree were taken
+        for (std::uint8_t i(0), workingSize(s.size); i + 1 < s.size; ++i, --workingSize)
+        {
+            const auto &step = s.steps[i];
+
+            auto &left = working[step.position];
+
+            left += working[step.position + 1];
+            left += static_cast<char>(operation_token + static_cast<std::uint8_t>(step.operation));
+
+            std::move(working.begin() + step.position + 2, working.begin() + workingSize, working.begin() + step.position + 1);
+        }
+
+        expressions.insert(std::move(working[0]));
+    }
+
+    return expressions.size();
+}
+
+void formatSolutionTrace(std::ostream &ss, const input_collection_type &input, const solution &s)
+{
+    std::array<input_type, solution::max_operands> working;
+
+    decltype(input.size()) size(s.size);
+
+    if (size == 1)
+    {
+        ss << "{" << std::to_string(input[s.operands[0]]) << "}\n";
+
+        return;
+    }
+
+    for (decltype(size) i(0); i < size; ++i) working[i] = input[s.operands[i]];
+
+    const auto writeWorkingSet = [&ss, &working, &size]()
+    {
+        ss << "{";
+
+        for (decltype(size) i = 0; i < size; ++i)
+        {
+            ss << working[i];
+
+            if (i != size - 1) ss << ", ";
+        }
+
+        ss << "}\n";
+    };
+
+    writeWorkingSet();
+
+    for (decltype(size) i(0), steps(s.size ? s.size - 1 : 0); i < steps; ++i)
+    {
+        const auto &step = s.steps[i];
+
+        ss << working[step.position] << Operation_ToString(step.operation) << working[step.position + 1] << ": ";
+
+        working[step.position] = Operation_PerformOperation(working[step.position], working[step.position + 1], step.operation);
+
+        std::copy(working.begin() + step.position + 2, working.begin() + size, working.begin() + step.position + 1);
+
+        --size;
+
+        writeWorkingSet();
+    }
+}
+
+std::vector<std::string> calculateSolutions(const input_type targetNumber, input_collection_type &&input)
+{
+    const auto result = findSolutions(targetNumber, std::move(input));
+
+    std::vector<std::string> solutions;
+
+    solutions.reserve(result.solutions.size());
+
+    for (const auto &s : result.solutions)
+    {
+        std::stringstream ss;
+
+        formatSolutionTrace(ss, result.input, s);
+
+        solutions.push_back(ss.str());
+    }
+
+    return solutions;
+}
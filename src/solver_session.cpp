@@ -0,0 +1,97 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <solver_session.h>
+
+#include <algorithm>
+
+solver_session::solver_session(const input_type target, input_collection_type input, const std::size_t cacheCapacity)
+: m_Target(target)
+, m_Input(std::move(input))
+, m_Cache(cacheCapacity)
+{}
+
+const expression_tables &solver_session::tables()
+{
+    if (!m_Tables) m_Tables = std::make_unique<expression_tables>(m_Input, false, solution::max_operands, &m_Cache);
+
+    return *m_Tables;
+}
+
+void solver_session::add(const input_type value)
+{
+    if (m_Input.size() == solution::max_operands) throw std::runtime_error("solver_session::add: input set is too large");
+
+    m_Input.push_back(value);
+
+    m_Tables.reset();
+}
+
+void solver_session::remove(const input_type value)
+{
+    const auto it = std::find(m_Input.begin(), m_Input.end(), value);
+
+    if (it == m_Input.end()) throw std::runtime_error([value]()
+    {
+        std::stringstream ss;
+
+        ss << "solver_session::remove: the hand does not contain " << value;
+
+        return ss.str();
+    }());
+
+    m_Input.erase(it);
+
+    m_Tables.reset();
+}
+
+void solver_session::change(const input_type from, const input_type to)
+{
+    const auto it = std::find(m_Input.begin(), m_Input.end(), from);
+
+    if (it == m_Input.end()) throw std::runtime_error([from]()
+    {
+        std::stringstream ss;
+
+        ss << "solver_session::change: the hand does not contain " << from;
+
+        return ss.str();
+    }());
+
+    *it = to;
+
+    m_Tables.reset();
+}
+
+void solver_session::setTarget(const input_type target)
+{
+    m_Target = target; // tables do not depend on the target
+}
+
+input_type solver_session::target() const
+{
+    return m_Target;
+}
+
+const input_collection_type &solver_session::input() const
+{
+    return m_Input;
+}
+
+expression_count solver_session::count()
+{
+    return tables().count(m_Target);
+}
+
+solution_set solver_session::solutions(const expression_count limit)
+{
+    const auto &t = tables();
+
+    solution_set output{m_Target, t.input(), {}};
+
+    const auto total = std::min(t.count(m_Target), limit);
+
+    output.solutions.reserve(static_cast<std::size_t>(total));
+
+    for (expression_count rank(0); rank < total; ++rank) output.solutions.push_back(t.unrank(m_Target, rank));
+
+    return output;
+}
@@ -0,0 +1,87 @@
+// © 2019 Joseph Cameron - All Rights Reserved
+#include <table_cache.h>
+
+std::size_t table_cache::key_hash::operator()(const key_type &key) const
+{
+    std::uint64_t hash(14695981039346656037ull);
+
+    for (const auto k : key) hash = (hash ^ k) * 1099511628211ull;
+
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+table_cache::table_cache(const std::size_t capacity)
+: m_ShardCapacity(capacity / SHARD_COUNT)
+{}
+
+table_cache::shard &table_cache::shardOf(const key_type &key)
+{
+    return m_Shards[key_hash()(key) % SHARD_COUNT];
+}
+
+table_cache::table_pointer table_cache::find(const key_type &key)
+{
+    auto &s = shardOf(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    const auto it = s.entries.find(key);
+
+    if (it == s.entries.end())
+    {
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+
+        return {};
+    }
+
+    m_Hits.fetch_add(1, std::memory_order_relaxed);
+
+    s.recency.splice(s.recency.begin(), s.recency, it->second.second);
+
+    return it->second.first;
+}
+
+void table_cache::insert(const key_type &key, table_pointer table)
+{
+    const auto cost = table->values.size() + 1;
+
+    if (cost > m_ShardCapacity || m_Frozen.load(std::memory_order_relaxed)) return;
+
+    auto &s = shardOf(key);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    if (s.entries.count(key)) return; // built concurrently by another thread
+
+    while (s.size + cost > m_ShardCapacity)
+    {
+        const auto victim = s.entries.find(s.recency.back());
+
+        s.size -= victim->second.first->values.size() + 1;
+
+        s.entries.erase(victim);
+
+        s.recency.pop_back();
+    }
+
+    s.recency.push_front(key);
+
+    s.entries.emplace(key, std::make_pair(std::move(table), s.recency.begin()));
+
+    s.size += cost;
+}
+
+void table_cache::freeze()
+{
+    m_Frozen.store(true, std::memory_order_relaxed);
+}
+
+std::uint64_t table_cache::hits() const
+{
+    return m_Hits.load(std::memory_order_relaxed);
+}
+
+std::uint64_t table_cache::misses() const
+{
+    return m_Misses.load(std::memory_order_relaxed);
+}
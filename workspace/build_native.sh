@@ -9,5 +9,6 @@ g++ \
     -I"${PUBLIC_HEADER_DIR}" \
     -I"${PRIVATE_HEADER_DIR}" \
     -std=c++17 \
+    -pthread \
     -DBUILD_NATIVE
 